@@ -0,0 +1,177 @@
+/**
+    @file BloomImplementation.c
+    @author Anastasia Marinakou | sdi2400120
+    @details Course: Data Structures and Programming Techniques (Even) - 2025
+    @brief Blocked Bloom filter used to answer negative lookups before searching the (2, 4) Tree
+*/
+
+#ifndef BLOOMIMPLEMENTATION_C
+#define BLOOMIMPLEMENTATION_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "BloomInterface.h"
+
+
+/**
+    @brief helper function to mix the bits of a key (murmur3 finalizer)
+    @param x the key to hash
+    @return 64-bit hash of x
+*/
+static uint64_t bloom_hash(Key x) {
+    uint64_t h = (uint64_t)(uint32_t)x;
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+
+/**
+    @brief helper function that picks the block of a key
+    @param filter the filter
+    @param h the hash of the key
+    @return pointer to the first word of the block
+*/
+static uint64_t * bloom_block(BloomFilter * filter, uint64_t h) {
+    // multiply-shift instead of modulo to map the upper 32 bits on [0, nblocks)
+    uint64_t index = ((h >> 32) * (uint64_t)filter->nblocks) >> 32;
+
+    return filter->blocks + index * BLOOM_BLOCK_WORDS;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+/**
+    @brief create a new blocked Bloom filter
+    @param expected the number of keys the filter should be sized for
+    @param bits_per_key how many bits to spend per key (more bits, less false positives)
+    @return pointer to the filter, NULL if allocation failed
+*/
+BloomFilter * bloom_create(int expected, int bits_per_key) {
+    if (bits_per_key <= 0) bits_per_key = BLOOM_DEFAULT_BITS_PER_KEY;
+    if (expected < 64) expected = 64;
+
+    BloomFilter * filter = (BloomFilter *)malloc(sizeof(struct bloom));
+
+    if (filter == NULL) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return NULL;
+    }
+
+    long bits = (long)expected * bits_per_key;
+
+    filter->nblocks = (int)((bits + BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS);
+
+    // blocks start on a cache line boundary, or one block could straddle two lines,
+    // aligned_alloc() needs a multiple of the alignment and every block is exactly one line
+    size_t bytes = (size_t)filter->nblocks * (BLOOM_BLOCK_BITS / 8);
+    filter->blocks = (uint64_t *)aligned_alloc(BLOOM_BLOCK_BITS / 8, bytes);
+
+    if (filter->blocks == NULL) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(filter);
+        return NULL;
+    }
+
+    memset(filter->blocks, 0, bytes);
+
+    // optimal number of hashes is bits_per_key * ln(2)
+    filter->k = (int)(bits_per_key * 0.69 + 0.5);
+    if (filter->k < 1) filter->k = 1;
+    if (filter->k > 16) filter->k = 16;
+
+    filter->bits_per_key = bits_per_key;
+    filter->capacity = expected;
+    filter->keys = 0;
+
+    filter->negatives = 0;
+    filter->true_positives = 0;
+    filter->false_positives = 0;
+
+    return filter;
+}
+
+
+/**
+    @brief add a key to the filter
+    @param filter the filter
+    @param x the key to add
+    @return -
+*/
+void bloom_add(BloomFilter * filter, Key x) {
+    if (filter == NULL) return;
+
+    uint64_t h = bloom_hash(x);
+    uint64_t * block = bloom_block(filter, h);
+
+    // double hashing inside the block, using the lower 32 bits
+    uint32_t a = (uint32_t)h;
+    uint32_t b = (a >> 16) | 1;
+
+    for (int i = 0; i < filter->k; i++) {
+        uint32_t bit = (a + i * b) & (BLOOM_BLOCK_BITS - 1);
+        block[bit >> 6] |= (uint64_t)1 << (bit & 63);
+    }
+
+    filter->keys++;
+}
+
+
+/**
+    @brief check if a key might be in the filter
+    @param filter the filter
+    @param x the key to look for
+    @return 0: x is definitely not in the set, 1: x might be in the set
+*/
+int bloom_may_contain(BloomFilter * filter, Key x) {
+    if (filter == NULL) return 1;
+
+    uint64_t h = bloom_hash(x);
+    uint64_t * block = bloom_block(filter, h);
+
+    uint32_t a = (uint32_t)h;
+    uint32_t b = (a >> 16) | 1;
+
+    for (int i = 0; i < filter->k; i++) {
+        uint32_t bit = (a + i * b) & (BLOOM_BLOCK_BITS - 1);
+        if (!(block[bit >> 6] & ((uint64_t)1 << (bit & 63)))) return 0;
+    }
+
+    return 1;
+}
+
+
+/**
+    @brief remove every key from the filter, keeping its size and statistics
+    @param filter the filter
+    @return -
+*/
+void bloom_clear(BloomFilter * filter) {
+    if (filter == NULL) return;
+
+    memset(filter->blocks, 0, (size_t)filter->nblocks * BLOOM_BLOCK_WORDS * sizeof(uint64_t));
+    filter->keys = 0;
+}
+
+
+/**
+    @brief frees a Bloom filter
+    @param filter the filter
+    @return -
+*/
+void bloom_destroy(BloomFilter * filter) {
+    if (filter == NULL) return;
+
+    free(filter->blocks);
+    free(filter);
+}
+
+#endif
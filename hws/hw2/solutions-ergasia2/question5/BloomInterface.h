@@ -0,0 +1,48 @@
+#ifndef BLOOMINTERFACE_H
+#define BLOOMINTERFACE_H
+
+#include <stdint.h>
+#include "Tree24Interface.h"
+
+// each block is one cache line (512 bits), so a lookup
+// touches exactly one line no matter how many hashes are used
+#define BLOOM_BLOCK_WORDS 8
+#define BLOOM_BLOCK_BITS 512
+
+// default bits per key used when 0 is given to enable_filter()
+#define BLOOM_DEFAULT_BITS_PER_KEY 10
+
+typedef struct bloom BloomFilter;
+
+struct bloom {
+    // the bit array, nblocks * BLOOM_BLOCK_WORDS words
+    uint64_t * blocks;
+    int nblocks;
+
+    // number of bits set per key (inside a single block)
+    int k;
+
+    int bits_per_key;
+
+    // how many keys the filter was sized for
+    int capacity;
+
+    // how many keys have been added since the last (re)build
+    int keys;
+
+    // query statistics, updated by search() in Tree24Implementation.c
+    // negatives: misses answered by the filter alone
+    // true_positives: filter said "maybe" and the key was in the tree
+    // false_positives: filter said "maybe" but the key was not in the tree
+    long negatives;
+    long true_positives;
+    long false_positives;
+};
+
+BloomFilter * bloom_create(int, int);
+void bloom_add(BloomFilter *, Key);
+int bloom_may_contain(BloomFilter *, Key);
+void bloom_clear(BloomFilter *);
+void bloom_destroy(BloomFilter *);
+
+#endif
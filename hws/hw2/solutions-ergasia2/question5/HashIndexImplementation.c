@@ -0,0 +1,290 @@
+/**
+    @file HashIndexImplementation.c
+    @author Anastasia Marinakou | sdi2400120
+    @details Course: Data Structures and Programming Techniques (Even) - 2025
+    @brief Open addressing hash table (linear probing over groups of tags) mapping keys to (2, 4) Tree nodes
+*/
+
+#ifndef HASHINDEXIMPLEMENTATION_C
+#define HASHINDEXIMPLEMENTATION_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "HashIndexInterface.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+/**
+    @brief helper function to mix the bits of a key (murmur3 finalizer)
+    @param x the key to hash
+    @return 64-bit hash of x
+*/
+static uint64_t hash_key(Key x) {
+    uint64_t h = (uint64_t)(uint32_t)x;
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+
+/**
+    @brief helper function that compares all the tags of a group with a given one
+    @param group pointer to the first of HASH_GROUP tags
+    @param tag the tag to look for
+    @return bitmask with bit i set if group[i] == tag
+*/
+static int match_tags(const uint8_t * group, uint8_t tag) {
+#ifdef __SSE2__
+    __m128i tags = _mm_loadu_si128((const __m128i *)group);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8((char)tag)));
+#else
+    int mask = 0;
+    for (int i = 0; i < HASH_GROUP; i++)
+        if (group[i] == tag) mask |= 1 << i;
+    return mask;
+#endif
+}
+
+
+/**
+    @brief helper function that finds the slot holding a key
+    @param index the hash table
+    @param x the key
+    @param h the hash of x
+    @return the slot of x, -1 if x is not in the table
+*/
+static int hash_find(HashIndex * index, Key x, uint64_t h) {
+    uint8_t tag = 0x80 | (h & 0x7f);
+    int mask = index->capacity / HASH_GROUP - 1;
+    int g = (int)((h >> 7) & mask);
+
+    for (int probes = 0; probes <= mask; probes++) {
+        const uint8_t * group = index->tags + g * HASH_GROUP;
+
+        // only the slots whose tag matches need their key compared
+        int candidates = match_tags(group, tag);
+        while (candidates) {
+            int slot = g * HASH_GROUP + __builtin_ctz(candidates);
+            if (index->keys[slot] == x) return slot;
+            candidates &= candidates - 1;
+        }
+
+        // an empty slot means the probe sequence of x stops here
+        if (match_tags(group, HASH_EMPTY)) return -1;
+
+        g = (g + 1) & mask;
+    }
+
+    return -1;
+}
+
+
+/**
+    @brief helper function that puts a key known not to be in the table in the first free slot
+    @param index the hash table, with at least one free slot
+    @param x the key
+    @param node the node containing x
+    @param h the hash of x
+    @return -
+*/
+static void hash_place(HashIndex * index, Key x, Tree24 * node, uint64_t h) {
+    int mask = index->capacity / HASH_GROUP - 1;
+    int g = (int)((h >> 7) & mask);
+
+    while (1) {
+        const uint8_t * group = index->tags + g * HASH_GROUP;
+        int free_slots = match_tags(group, HASH_EMPTY) | match_tags(group, HASH_DELETED);
+
+        if (free_slots) {
+            int slot = g * HASH_GROUP + __builtin_ctz(free_slots);
+
+            if (index->tags[slot] == HASH_EMPTY) index->used++;
+            index->size++;
+
+            index->tags[slot] = 0x80 | (h & 0x7f);
+            index->keys[slot] = x;
+            index->nodes[slot] = node;
+            return;
+        }
+
+        g = (g + 1) & mask;
+    }
+}
+
+
+/**
+    @brief helper function that moves every key to a table of a new size, dropping tombstones
+    @param index the hash table
+    @param capacity the new number of slots (power of two)
+    @return 0 on success, -1 if allocation failed (the table is left as it was)
+*/
+static int hash_resize(HashIndex * index, int capacity) {
+    uint8_t * tags = (uint8_t *)calloc(capacity, sizeof(uint8_t));
+    Key * keys = (Key *)malloc(capacity * sizeof(Key));
+    Tree24 ** nodes = (Tree24 **)malloc(capacity * sizeof(Tree24 *));
+
+    if (tags == NULL || keys == NULL || nodes == NULL) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(tags);
+        free(keys);
+        free(nodes);
+        return -1;
+    }
+
+    uint8_t * old_tags = index->tags;
+    Key * old_keys = index->keys;
+    Tree24 ** old_nodes = index->nodes;
+    int old_capacity = index->capacity;
+
+    index->tags = tags;
+    index->keys = keys;
+    index->nodes = nodes;
+    index->capacity = capacity;
+    index->size = 0;
+    index->used = 0;
+
+    for (int i = 0; i < old_capacity; i++)
+        if (old_tags[i] & 0x80) hash_place(index, old_keys[i], old_nodes[i], hash_key(old_keys[i]));
+
+    free(old_tags);
+    free(old_keys);
+    free(old_nodes);
+
+    return 0;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+/**
+    @brief create a new hash index
+    @param expected the number of keys the table should hold without growing
+    @return pointer to the table, NULL if allocation failed
+*/
+HashIndex * hash_create(int expected) {
+    HashIndex * index = (HashIndex *)malloc(sizeof(struct hash_index));
+
+    if (index == NULL) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return NULL;
+    }
+
+    // keep the load factor under 7/8
+    int capacity = HASH_GROUP;
+    while (capacity / 8 * 7 < expected) capacity *= 2;
+
+    index->tags = NULL;
+    index->keys = NULL;
+    index->nodes = NULL;
+    index->capacity = 0;
+
+    if (hash_resize(index, capacity) != 0) {
+        free(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+
+/**
+    @brief find the node that contains a key
+    @param index the hash table
+    @param x the key to look for
+    @return the node containing x, NULL if x is not in the table
+*/
+Tree24 * hash_lookup(HashIndex * index, Key x) {
+    if (index == NULL) return NULL;
+
+    int slot = hash_find(index, x, hash_key(x));
+
+    return (slot == -1) ? NULL : index->nodes[slot];
+}
+
+
+/**
+    @brief insert a key or, if it already exists, update the node it maps to
+    @param index the hash table
+    @param x the key
+    @param node the node that now contains x
+    @return 0 on success, -1 if the table had to grow and there was no memory
+*/
+int hash_put(HashIndex * index, Key x, Tree24 * node) {
+    if (index == NULL) return -1;
+
+    uint64_t h = hash_key(x);
+    int slot = hash_find(index, x, h);
+
+    if (slot != -1) {
+        index->nodes[slot] = node;
+        return 0;
+    }
+
+    if (index->used + 1 > index->capacity / 8 * 7) {
+        // grow only if the live keys need it, otherwise just clear the tombstones
+        int capacity = (index->size + 1 > index->capacity / 2) ? 2 * index->capacity : index->capacity;
+        if (hash_resize(index, capacity) != 0) return -1;
+    }
+
+    hash_place(index, x, node, h);
+
+    return 0;
+}
+
+
+/**
+    @brief remove a key from the table
+    @param index the hash table
+    @param x the key to remove
+    @return -
+*/
+void hash_remove(HashIndex * index, Key x) {
+    if (index == NULL) return;
+
+    int slot = hash_find(index, x, hash_key(x));
+
+    if (slot == -1) return;
+
+    // leave a tombstone so the probe sequences passing through this slot still work
+    index->tags[slot] = HASH_DELETED;
+    index->size--;
+}
+
+
+/**
+    @brief memory used by the table
+    @param index the hash table
+    @return the size of the table in bytes
+*/
+long hash_memory(HashIndex * index) {
+    if (index == NULL) return 0;
+
+    return (long)sizeof(struct hash_index) + (long)index->capacity * (sizeof(uint8_t) + sizeof(Key) + sizeof(Tree24 *));
+}
+
+
+/**
+    @brief frees a hash index
+    @param index the hash table
+    @return -
+*/
+void hash_destroy(HashIndex * index) {
+    if (index == NULL) return;
+
+    free(index->tags);
+    free(index->keys);
+    free(index->nodes);
+    free(index);
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef HASHINDEXINTERFACE_H
+#define HASHINDEXINTERFACE_H
+
+#include <stdint.h>
+#include "Tree24Interface.h"
+
+// slots are probed in groups of 16, so that one SSE2 compare
+// checks the tags of the whole group at once
+#define HASH_GROUP 16
+
+// tag values: a full slot stores 0x80 | 7 bits of the hash
+#define HASH_EMPTY 0x00
+#define HASH_DELETED 0x01
+
+typedef struct hash_index HashIndex;
+
+struct hash_index {
+    // one tag byte per slot
+    uint8_t * tags;
+
+    // the key stored in each slot and the tree node that contains it
+    Key * keys;
+    Tree24 ** nodes;
+
+    // number of slots, a power of two (and a multiple of HASH_GROUP)
+    int capacity;
+
+    // slots holding a key
+    int size;
+
+    // slots holding a key or a tombstone
+    int used;
+};
+
+HashIndex * hash_create(int);
+Tree24 * hash_lookup(HashIndex *, Key);
+int hash_put(HashIndex *, Key, Tree24 *);
+void hash_remove(HashIndex *, Key);
+long hash_memory(HashIndex *);
+void hash_destroy(HashIndex *);
+
+#endif
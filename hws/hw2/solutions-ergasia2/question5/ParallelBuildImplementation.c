@@ -0,0 +1,551 @@
+/**
+    @file ParallelBuildImplementation.c
+    @author Anastasia Marinakou | sdi2400120
+    @details Course: Data Structures and Programming Techniques (Even) - 2025
+    @brief Multi-threaded bulk build of a (2, 4) Tree from unsorted keys
+    @details parallel_build() works in four phases, each one split over the threads:
+        1. the input is cut into one part per thread and every part is radix sorted
+           and cleared of duplicates
+        2. splitters chosen from samples of the sorted parts cut the key range into
+           one slice per thread, and every thread merges its slice of all the parts
+           (dropping duplicates between parts)
+        3. the merged slices are moved next to each other
+        4. the tree is assembled bottom-up with the same layout as build_sorted():
+           the node a key (or child) ends up in only depends on its position,
+           so every thread builds its own range of leaves, then of parents, and so on.
+*/
+
+#ifndef PARALLELBUILDIMPLEMENTATION_C
+#define PARALLELBUILDIMPLEMENTATION_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "Tree24Interface.h"
+
+// from Tree24Implementation.c
+Tree24 * create_node();
+
+// levels with fewer nodes than this are built by a single thread
+#define PARALLEL_MIN_NODES 4096
+
+// samples taken from every sorted part to choose the splitters
+#define PARALLEL_SAMPLES 64
+
+
+// state shared by the threads of one parallel_build()
+struct parallel_build {
+    int threads;
+    int n;
+
+    // input (and, after phase 3, the merged keys) and a scratch array of the same size
+    Item * keys;
+    Item * tmp;
+
+    // part i is keys[part_start[i] .. part_start[i] + part_n[i]) after phase 1
+    int * part_start;
+    int * part_n;
+
+    // slice j of part i is [cut[j * (threads + 1) + i], cut[(j + 1) * (threads + 1) + i])
+    int * cut;
+
+    // slice j is merged into tmp[out_start[j] ..), out_n[j] keys
+    int * out_start;
+    int * out_n;
+
+    // the level being built (phase 4)
+    Tree24 ** below;
+    int * below_sizes;
+    Item * below_seps;
+    Tree24 ** level;
+    int * sizes;
+    Item * seps;
+    int level_n;
+    int below_n;
+    int leaf_keys;
+};
+
+// argument of every thread: the shared state and the thread's number
+struct parallel_task {
+    struct parallel_build * b;
+    int id;
+};
+
+
+/**
+    @brief helper function that runs a function on every thread and waits for all of them,
+    the caller runs the part of any thread that cannot be started
+    @param b the shared state
+    @param work the function, called with a struct parallel_task *
+    @return -
+*/
+void parallel_run(struct parallel_build * b, void * (*work)(void *)) {
+    pthread_t workers[b->threads];
+    struct parallel_task tasks[b->threads];
+    int started[b->threads];
+
+    for (int i = 0; i < b->threads; i++) {
+        tasks[i].b = b;
+        tasks[i].id = i;
+    }
+
+    // thread 0 is the caller, the work of a thread that cannot start is done by the caller
+    for (int i = 1; i < b->threads; i++) started[i] = (pthread_create(&workers[i], NULL, work, &tasks[i]) == 0);
+    work(&tasks[0]);
+
+    for (int i = 1; i < b->threads; i++) {
+        if (started[i]) pthread_join(workers[i], NULL);
+        else work(&tasks[i]);
+    }
+}
+
+
+/**
+    @brief helper function that returns the range [lo, hi) of the count items given to a thread
+    @param count the number of items
+    @param threads the number of threads
+    @param id the thread
+    @param lo the first item of the thread
+    @param hi one past the last item of the thread
+    @return -
+*/
+void parallel_range(int count, int threads, int id, int * lo, int * hi) {
+    *lo = (int)((int64_t)count * id / threads);
+    *hi = (int)((int64_t)count * (id + 1) / threads);
+}
+
+
+/**
+    @brief helper function that sorts keys with an LSD radix sort (4 passes of 8 bits)
+    @param a the keys, sorted on return
+    @param scratch space for n keys
+    @param n the number of keys
+    @return -
+*/
+void radix_sort(Item * a, Item * scratch, int n) {
+    Item * from = a;
+    Item * to = scratch;
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        int counts[256] = { 0 };
+
+        // flipping the sign bit orders negative keys before positive ones
+        for (int i = 0; i < n; i++) counts[(((uint32_t)from[i] ^ 0x80000000u) >> shift) & 255]++;
+
+        int sum = 0;
+        for (int d = 0; d < 256; d++) {
+            int c = counts[d];
+            counts[d] = sum;
+            sum += c;
+        }
+
+        for (int i = 0; i < n; i++) to[counts[(((uint32_t)from[i] ^ 0x80000000u) >> shift) & 255]++] = from[i];
+
+        Item * t = from;
+        from = to;
+        to = t;
+    }
+
+    // after an even number of passes the keys are back in a
+}
+
+
+/**
+    @brief helper function that returns the first position of a sorted array with a key >= x
+    @param a the keys
+    @param n the number of keys
+    @param x the key
+    @return the position, n if every key is smaller
+*/
+int lower_bound(Item * a, int n, Item x) {
+    int lo = 0, hi = n;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (a[mid] < x) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return lo;
+}
+
+
+/**
+    @brief phase 1: sort a part of the input and remove its duplicates
+    @param arg the thread's struct parallel_task
+    @return NULL
+*/
+void * sort_part(void * arg) {
+    struct parallel_task * task = (struct parallel_task *)arg;
+    struct parallel_build * b = task->b;
+    int lo, hi;
+
+    parallel_range(b->n, b->threads, task->id, &lo, &hi);
+
+    Item * part = b->keys + lo;
+    int n = hi - lo;
+
+    radix_sort(part, b->tmp + lo, n);
+
+    int m = 0;
+    for (int i = 0; i < n; i++)
+        if (m == 0 || part[i] != part[m - 1]) part[m++] = part[i];
+
+    b->part_start[task->id] = lo;
+    b->part_n[task->id] = m;
+
+    return NULL;
+}
+
+
+/**
+    @brief helper function that moves a part down a min-heap of parts, ordered by their next key
+    @param keys the keys of every part
+    @param pos the position of the next key of every part
+    @param heap the parts in the heap
+    @param size the number of parts in the heap
+    @param at the place in the heap of the part to move
+    @return -
+*/
+void merge_sift(Item * keys, int * pos, int * heap, int size, int at) {
+    int part = heap[at];
+    Item x = keys[pos[part]];
+
+    while (2 * at + 1 < size) {
+        int child = 2 * at + 1;
+        if (child + 1 < size && keys[pos[heap[child + 1]]] < keys[pos[heap[child]]]) child++;
+        if (keys[pos[heap[child]]] >= x) break;
+
+        heap[at] = heap[child];
+        at = child;
+    }
+
+    heap[at] = part;
+}
+
+
+/**
+    @brief phase 2: merge slice task->id of every part into tmp, dropping duplicates
+    @details the parts are kept in a min-heap ordered by their next key, so every key
+    costs O(log threads) comparisons
+    @param arg the thread's struct parallel_task
+    @return NULL
+*/
+void * merge_slice(void * arg) {
+    struct parallel_task * task = (struct parallel_task *)arg;
+    struct parallel_build * b = task->b;
+    int t = b->threads;
+    int j = task->id;
+
+    int pos[t], end[t], heap[t];
+    int size = 0;
+
+    for (int i = 0; i < t; i++) {
+        pos[i] = b->part_start[i] + b->cut[j * (t + 1) + i];
+        end[i] = b->part_start[i] + b->cut[(j + 1) * (t + 1) + i];
+
+        if (pos[i] < end[i]) heap[size++] = i;
+    }
+
+    for (int i = size / 2 - 1; i >= 0; i--) merge_sift(b->keys, pos, heap, size, i);
+
+    Item * out = b->tmp + b->out_start[j];
+    int m = 0;
+
+    while (size > 0) {
+        // the part with the smallest key left in the slice is at the top
+        int best = heap[0];
+
+        Item x = b->keys[pos[best]++];
+        if (m == 0 || out[m - 1] != x) out[m++] = x;
+
+        if (pos[best] == end[best]) heap[0] = heap[--size];
+        if (size > 0) merge_sift(b->keys, pos, heap, size, 0);
+    }
+
+    b->out_n[j] = m;
+
+    return NULL;
+}
+
+
+/**
+    @brief phase 3: move merged slice task->id to its final place in keys
+    @param arg the thread's struct parallel_task
+    @return NULL
+*/
+void * compact_slice(void * arg) {
+    struct parallel_task * task = (struct parallel_task *)arg;
+    struct parallel_build * b = task->b;
+    int j = task->id;
+
+    int to = 0;
+    for (int i = 0; i < j; i++) to += b->out_n[i];
+
+    memcpy(b->keys + to, b->tmp + b->out_start[j], b->out_n[j] * sizeof(Item));
+
+    return NULL;
+}
+
+
+/**
+    @brief helper function that allocates a node and exits if it cannot
+    @return an empty node
+*/
+Tree24 * parallel_node() {
+    Tree24 * node = create_node();
+
+    // same as init(), a half built tree cannot be recovered
+    if (node == NULL) exit(1);
+
+    return node;
+}
+
+
+/**
+    @brief phase 4, leaves: build the leaves of thread task->id, the same way as build_sorted()
+    @details leaf j holds leaf_keys / level_n keys (one more for the first leaf_keys % level_n
+    leaves) and is followed by one separator, so where it starts can be computed directly
+    @param arg the thread's struct parallel_task
+    @return NULL
+*/
+void * build_leaves(void * arg) {
+    struct parallel_task * task = (struct parallel_task *)arg;
+    struct parallel_build * b = task->b;
+    int base = b->leaf_keys / b->level_n;
+    int extra = b->leaf_keys % b->level_n;
+    int lo, hi;
+
+    parallel_range(b->level_n, b->threads, task->id, &lo, &hi);
+
+    for (int j = lo; j < hi; j++) {
+        Tree24 * leaf = parallel_node();
+        int next = j * (base + 1) + (j < extra ? j : extra);
+
+        leaf->Count = base + (j < extra);
+        for (int i = 0; i < leaf->Count; i++) leaf->items[i] = b->keys[next++];
+
+        b->level[j] = leaf;
+        b->sizes[j] = leaf->Count;
+        if (j < b->level_n - 1) b->seps[j] = b->keys[next];
+    }
+
+    return NULL;
+}
+
+
+/**
+    @brief phase 4, internal nodes: build the parents of thread task->id over the level below
+    @param arg the thread's struct parallel_task
+    @return NULL
+*/
+void * build_parents(void * arg) {
+    struct parallel_task * task = (struct parallel_task *)arg;
+    struct parallel_build * b = task->b;
+    int base = b->below_n / b->level_n;
+    int extra = b->below_n % b->level_n;
+    int lo, hi;
+
+    parallel_range(b->level_n, b->threads, task->id, &lo, &hi);
+
+    for (int j = lo; j < hi; j++) {
+        Tree24 * parent = parallel_node();
+        int children = base + (j < extra);
+        int child = j * base + (j < extra ? j : extra);
+        int size = 0;
+
+        for (int i = 0; i < children; i++, child++) {
+            parent->children[i] = b->below[child];
+            parent->N[i] = b->below_sizes[child];
+            b->below[child]->parent = parent;
+            size += b->below_sizes[child];
+
+            if (i < children - 1) parent->items[parent->Count++] = b->below_seps[child];
+        }
+
+        b->level[j] = parent;
+        b->sizes[j] = size + parent->Count;
+        if (j < b->level_n - 1) b->seps[j] = b->below_seps[child - 1];
+    }
+
+    return NULL;
+}
+
+
+/**
+    @brief helper function that builds one level of the tree, in parallel if it is large enough
+    @param b the shared state
+    @param work build_leaves or build_parents
+    @return -
+*/
+void build_level(struct parallel_build * b, void * (*work)(void *)) {
+    int threads = b->threads;
+
+    if (b->level_n < PARALLEL_MIN_NODES) b->threads = 1;
+    parallel_run(b, work);
+
+    b->threads = threads;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+/**
+    @brief build a (2, 4) Tree from unsorted keys (duplicates allowed) with many threads
+    @details gives the same tree as sorting the keys, removing duplicates and calling
+    build_sorted(), the global tree is not changed
+    @param keys the keys, not changed
+    @param n the number of keys
+    @param threads the number of threads (1 or more)
+    @return the root of the new tree, NULL if allocation failed
+*/
+Tree24 * parallel_build(Item * keys, int n, int threads) {
+    if (threads < 1) threads = 1;
+
+    // every thread should get enough keys to be worth starting
+    if (threads > n / 1024 + 1) threads = n / 1024 + 1;
+
+    if (n <= 0) return build_sorted(keys, 0);
+
+    struct parallel_build b;
+    memset(&b, 0, sizeof(b));
+
+    b.threads = threads;
+    b.n = n;
+    b.keys = (Item *)malloc(n * sizeof(Item));
+    b.tmp = (Item *)malloc(n * sizeof(Item));
+    b.part_start = (int *)malloc(threads * sizeof(int));
+    b.part_n = (int *)malloc(threads * sizeof(int));
+    b.cut = (int *)malloc((threads + 1) * (threads + 1) * sizeof(int));
+    b.out_start = (int *)malloc(threads * sizeof(int));
+    b.out_n = (int *)malloc(threads * sizeof(int));
+
+    // the second half is scratch space for sorting the first
+    int samples_n = threads * PARALLEL_SAMPLES;
+    Item * samples = (Item *)malloc(2 * samples_n * sizeof(Item));
+
+    if (!b.keys || !b.tmp || !b.part_start || !b.part_n || !b.cut || !b.out_start || !b.out_n || !samples) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(b.keys);
+        free(b.tmp);
+        free(b.part_start);
+        free(b.part_n);
+        free(b.cut);
+        free(b.out_start);
+        free(b.out_n);
+        free(samples);
+        return NULL;
+    }
+
+    memcpy(b.keys, keys, n * sizeof(Item));
+
+    // phase 1
+    parallel_run(&b, sort_part);
+
+    // phase 2: evenly spaced samples of every part, sorted, give threads - 1 splitters;
+    // slice j holds the keys in [splitter j - 1, splitter j)
+    int taken = 0;
+
+    for (int i = 0; i < threads; i++)
+        for (int s = 0; s < PARALLEL_SAMPLES && b.part_n[i] > 0; s++)
+            samples[taken++] = b.keys[b.part_start[i] + (int)((int64_t)b.part_n[i] * s / PARALLEL_SAMPLES)];
+
+    radix_sort(samples, samples + samples_n, taken);
+
+    for (int i = 0; i < threads; i++) {
+        b.cut[i] = 0;
+        b.cut[threads * (threads + 1) + i] = b.part_n[i];
+    }
+
+    for (int j = 1; j < threads; j++) {
+        Item splitter = samples[(int)((int64_t)taken * j / threads)];
+
+        for (int i = 0; i < threads; i++)
+            b.cut[j * (threads + 1) + i] = lower_bound(b.keys + b.part_start[i], b.part_n[i], splitter);
+    }
+
+    // slice j is written after the room needed by slices 0 .. j - 1 (before removing duplicates)
+    int room = 0;
+
+    for (int j = 0; j < threads; j++) {
+        b.out_start[j] = room;
+        for (int i = 0; i < threads; i++) room += b.cut[(j + 1) * (threads + 1) + i] - b.cut[j * (threads + 1) + i];
+    }
+
+    parallel_run(&b, merge_slice);
+
+    // phase 3
+    parallel_run(&b, compact_slice);
+
+    int distinct = 0;
+    for (int j = 0; j < threads; j++) distinct += b.out_n[j];
+
+    free(b.tmp);
+    free(b.part_start);
+    free(b.part_n);
+    free(b.cut);
+    free(b.out_start);
+    free(b.out_n);
+    free(samples);
+
+    // phase 4: leaves, then one level at a time (see bulk_build() in Tree24Implementation.c)
+    b.level_n = (distinct + 4) / 4;
+    b.leaf_keys = distinct - (b.level_n - 1);
+
+    b.level = (Tree24 **)malloc(b.level_n * sizeof(Tree24 *));
+    b.sizes = (int *)malloc(b.level_n * sizeof(int));
+    b.seps = (Item *)malloc(b.level_n * sizeof(Item));
+    b.below = (Tree24 **)malloc(b.level_n * sizeof(Tree24 *));
+    b.below_sizes = (int *)malloc(b.level_n * sizeof(int));
+    b.below_seps = (Item *)malloc(b.level_n * sizeof(Item));
+
+    if (!b.level || !b.sizes || !b.seps || !b.below || !b.below_sizes || !b.below_seps) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(b.keys);
+        free(b.level);
+        free(b.sizes);
+        free(b.seps);
+        free(b.below);
+        free(b.below_sizes);
+        free(b.below_seps);
+        return NULL;
+    }
+
+    build_level(&b, build_leaves);
+
+    while (b.level_n > 1) {
+        // the level just built becomes the level below
+        Tree24 ** nodes = b.below;
+        int * sizes = b.below_sizes;
+        Item * seps = b.below_seps;
+
+        b.below = b.level;
+        b.below_sizes = b.sizes;
+        b.below_seps = b.seps;
+        b.level = nodes;
+        b.sizes = sizes;
+        b.seps = seps;
+
+        b.below_n = b.level_n;
+        b.level_n = (b.below_n + 3) / 4;
+
+        build_level(&b, build_parents);
+    }
+
+    Tree24 * root = b.level[0];
+
+    free(b.keys);
+    free(b.level);
+    free(b.sizes);
+    free(b.seps);
+    free(b.below);
+    free(b.below_sizes);
+    free(b.below_seps);
+
+    return root;
+}
+
+#endif
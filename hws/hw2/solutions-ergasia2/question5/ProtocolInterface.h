@@ -0,0 +1,46 @@
+#ifndef PROTOCOLINTERFACE_H
+#define PROTOCOLINTERFACE_H
+
+#include <stdint.h>
+
+// binary protocol between server.c and its clients over a Unix domain socket.
+// A client may send any number of requests without waiting (pipelining);
+// the server answers them in the same order. Integers are in host byte order,
+// since both sides run on the same machine.
+
+#define PROTOCOL_SOCKET "/tmp/tree24.sock"
+
+// trees served by one server, selected by the tree field of a request
+#define PROTOCOL_TREES 16
+
+// operations
+#define OP_INSERT 1
+#define OP_DELETE 2
+#define OP_SEARCH 3
+#define OP_FIND 4   // key is the position k, value is the k-th smallest key
+#define OP_COUNT 5
+#define OP_RANGE 6  // keys in [key, key2], value is their number and they follow the response
+
+// status of a response
+#define STATUS_OK 0
+#define STATUS_MISSING 1  // key not found, already inserted, or position out of range
+#define STATUS_BAD 2      // unknown operation or tree
+#define STATUS_FAILED 3   // the server ran out of memory, no keys follow a failed range scan
+
+// one request, always 12 bytes
+typedef struct request {
+    uint8_t op;
+    uint8_t tree;
+    uint16_t unused;
+    int32_t key;
+    int32_t key2;
+} Request;
+
+// one response, always 8 bytes (followed by value keys for OP_RANGE)
+typedef struct response {
+    uint8_t status;
+    uint8_t unused[3];
+    int32_t value;
+} Response;
+
+#endif
@@ -0,0 +1,879 @@
+/**
+    @file SkipListImplementation.c
+    @author Anastasia Marinakou | sdi2400120
+    @details Course: Data Structures and Programming Techniques (Even) - 2025
+    @brief Lock-free skip list implementing the operations of Tree24Interface.h
+    @details Link this file instead of Tree24Implementation.c (see target q5-skiplist
+    in the Makefile) to get an ordered set that many threads can update at once.
+
+    - Every level is a sorted linked list. A node is removed by marking the low bit
+      of its next pointers (top level first, level 0 last), so no thread can link
+      anything after it, and is then unlinked with CAS by any thread that passes by.
+      Marking level 0 is the point where the delete takes effect.
+    - Unlinked nodes are freed with epoch-based reclamation: a node retired in
+      epoch e is freed once the global epoch reaches e + 3: a thread that could still
+      hold it started its operation in epoch e + 1 at the latest.
+    - find(k) follows the span counts (how many level 0 nodes each link skips) in
+      O(log n). After linking or unlinking its node, insert() and delete() recompute
+      the spans of the links around the key, bottom-up, in O(log n) (see repair_spans()).
+      Those repairs are serialized by SpanLock, but the update itself took effect
+      before, and search(), range() and find() never wait for them. find() is only
+      exact if no update runs at the same time.
+    - A thread takes a slot of Threads[] on its first operation and gives it back
+      when it exits; its limbo lists are handed over to Orphans.
+*/
+
+#ifndef SKIPLISTIMPLEMENTATION_C
+#define SKIPLISTIMPLEMENTATION_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "Tree24Interface.h"
+
+// enough for 2^32 keys with p = 1/2
+#define SKIP_MAX_LEVEL 32
+
+// the most threads that can use the list during its lifetime
+#define SKIP_MAX_THREADS 128
+
+// try to advance the epoch every this many retired nodes
+#define SKIP_RETIRE_BATCH 64
+
+typedef struct skipnode SkipNode;
+
+struct skiplink {
+    // next node at this level, the low bit marks the owner as deleted
+    _Atomic uintptr_t next;
+
+    // number of level 0 links this link skips (see find()), always 1 at level 0
+    atomic_int span;
+};
+
+struct skipnode {
+    Key key;
+    int height;
+
+    // the inserting and the deleting thread each hold one reference,
+    // the last one to finish unlinking retires the node
+    atomic_int owners;
+
+    // next node in a limbo list, once retired
+    SkipNode * limbo;
+
+    struct skiplink level[];
+};
+
+// per thread state for epoch-based reclamation
+struct skipthread {
+    // the epoch this thread saw when it started its current operation
+    atomic_ulong epoch;
+    atomic_int active;
+
+    // retired nodes waiting to be freed, one list for each of the last 3 epochs
+    // and the epoch each list belongs to
+    SkipNode * limbo[3];
+    unsigned long limbo_epoch[3];
+    int retired;
+
+    // 1 while a thread owns this slot
+    atomic_int taken;
+};
+
+
+// the list itself, head is a sentinel of height SKIP_MAX_LEVEL
+SkipNode * Head = NULL;
+
+atomic_long Size;
+
+atomic_ulong Epoch;
+struct skipthread Threads[SKIP_MAX_THREADS];
+
+// every slot ever taken is below ThreadCount
+atomic_int ThreadCount;
+
+// releases the slot of a thread when it exits (see thread_exit())
+pthread_key_t ThreadKey;
+pthread_once_t ThreadKeyOnce = PTHREAD_ONCE_INIT;
+
+// limbo lists of the threads that have exited, kept like the lists of a thread
+SkipNode * Orphans[3];
+unsigned long OrphanEpoch[3];
+pthread_mutex_t OrphanLock = PTHREAD_MUTEX_INITIALIZER;
+
+// serializes the span repairs of insert() and delete() (see repair_spans())
+pthread_mutex_t SpanLock = PTHREAD_MUTEX_INITIALIZER;
+
+int Verbose = 1;
+
+// slot in Threads[] and random state of the calling thread
+_Thread_local int ThreadId = -1;
+_Thread_local uint64_t Seed = 0;
+
+
+#define IS_MARKED(p) ((p) & 1)
+#define UNMARK(p) ((SkipNode *)((p) & ~(uintptr_t)1))
+
+
+void newline() {
+    printf("\n");
+}
+
+
+/**
+    @brief function passed on to other functions to print the keys in a node.
+    @param i Item to print
+    @return none
+*/
+void visit(Item i) {
+    printf("%d ", i);
+}
+
+
+/**
+    @brief helper function that frees a limbo list
+    @param node the first node of the list
+    @return -
+*/
+void free_limbo(SkipNode * node) {
+    while (node != NULL) {
+        SkipNode * next = node->limbo;
+        free(node);
+        node = next;
+    }
+}
+
+
+/**
+    @brief helper function that adds the limbo list of an exiting thread to Orphans (OrphanLock held)
+    @details the lists of Orphans follow the same rule as the lists of a thread: the list
+    of slot epoch % 3 belongs to epoch, and an older one in that slot is safe to free
+    @param list the limbo list
+    @param epoch the epoch it belongs to
+    @return -
+*/
+void orphan_limbo(SkipNode * list, unsigned long epoch) {
+    int slot = epoch % 3;
+
+    if (Orphans[slot] != NULL && OrphanEpoch[slot] != epoch) {
+        // whichever of the two lists is older is safe to free
+        if (OrphanEpoch[slot] > epoch) {
+            free_limbo(list);
+            return;
+        }
+
+        free_limbo(Orphans[slot]);
+        Orphans[slot] = NULL;
+    }
+
+    SkipNode * last = list;
+    while (last->limbo != NULL) last = last->limbo;
+
+    last->limbo = Orphans[slot];
+    Orphans[slot] = list;
+    OrphanEpoch[slot] = epoch;
+}
+
+
+/**
+    @brief helper function called when a thread that used the list exits: hands its limbo lists
+    over to Orphans and gives its slot of Threads[] back
+    @param state the state of the thread
+    @return -
+*/
+void thread_exit(void * state) {
+    struct skipthread * self = (struct skipthread *)state;
+
+    atomic_store(&self->active, 0);
+
+    pthread_mutex_lock(&OrphanLock);
+    for (int i = 0; i < 3; i++) {
+        if (self->limbo[i] != NULL) orphan_limbo(self->limbo[i], self->limbo_epoch[i]);
+        self->limbo[i] = NULL;
+    }
+    pthread_mutex_unlock(&OrphanLock);
+
+    self->retired = 0;
+    ThreadId = -1;
+
+    atomic_store(&self->taken, 0);
+}
+
+
+/**
+    @brief helper function that creates the key whose destructor is thread_exit()
+    @return -
+*/
+void thread_key_create() {
+    pthread_key_create(&ThreadKey, thread_exit);
+}
+
+
+/**
+    @brief helper function that returns the reclamation state of the calling thread
+    @return pointer to the state of this thread
+*/
+struct skipthread * this_thread() {
+    if (ThreadId == -1) {
+        pthread_once(&ThreadKeyOnce, thread_key_create);
+
+        // the first free slot
+        int id = -1;
+        for (int i = 0; i < SKIP_MAX_THREADS && id == -1; i++) {
+            int free_slot = 0;
+            if (atomic_compare_exchange_strong(&Threads[i].taken, &free_slot, 1)) id = i;
+        }
+
+        if (id == -1) {
+            fprintf(stderr, "Too many threads at once (at most %d).\n", SKIP_MAX_THREADS);
+            exit(1);
+        }
+
+        // try_advance() only looks at the slots below ThreadCount
+        int threads = atomic_load(&ThreadCount);
+        while (threads <= id && !atomic_compare_exchange_weak(&ThreadCount, &threads, id + 1));
+
+        ThreadId = id;
+        Seed = 0x9e3779b97f4a7c15ULL * (uint64_t)(ThreadId + 1);
+
+        pthread_setspecific(ThreadKey, &Threads[id]);
+    }
+
+    return &Threads[ThreadId];
+}
+
+
+/**
+    @brief helper function that marks the start of an operation, nodes seen from now on
+    will not be freed until operation_end()
+    @return the state of this thread
+*/
+struct skipthread * operation_begin() {
+    struct skipthread * self = this_thread();
+
+    atomic_store(&self->active, 1);
+    atomic_store(&self->epoch, atomic_load(&Epoch));
+
+    return self;
+}
+
+
+/**
+    @brief helper function that marks the end of an operation
+    @param self the state of this thread
+    @return -
+*/
+void operation_end(struct skipthread * self) {
+    atomic_store(&self->active, 0);
+}
+
+
+/**
+    @brief helper function that frees the limbo lists of this thread nobody can see anymore
+    @param self the state of this thread
+    @param epoch the current global epoch
+    @return -
+*/
+void free_old_limbo(struct skipthread * self, unsigned long epoch) {
+    for (int i = 0; i < 3; i++) {
+        if (self->limbo[i] != NULL && self->limbo_epoch[i] + 3 <= epoch) {
+            free_limbo(self->limbo[i]);
+            self->limbo[i] = NULL;
+        }
+    }
+}
+
+
+/**
+    @brief helper function that moves the global epoch forward if every active thread has seen it
+    @param self the state of this thread
+    @return -
+*/
+void try_advance(struct skipthread * self) {
+    unsigned long epoch = atomic_load(&Epoch);
+    int threads = atomic_load(&ThreadCount);
+
+    for (int i = 0; i < threads && i < SKIP_MAX_THREADS; i++)
+        if (atomic_load(&Threads[i].active) && atomic_load(&Threads[i].epoch) != epoch) return;
+
+    if (atomic_compare_exchange_strong(&Epoch, &epoch, epoch + 1)) epoch++;
+
+    free_old_limbo(self, epoch);
+
+    // the lists of the threads that have exited, unless another thread is at it
+    if (pthread_mutex_trylock(&OrphanLock) == 0) {
+        for (int i = 0; i < 3; i++) {
+            if (Orphans[i] != NULL && OrphanEpoch[i] + 3 <= epoch) {
+                free_limbo(Orphans[i]);
+                Orphans[i] = NULL;
+            }
+        }
+        pthread_mutex_unlock(&OrphanLock);
+    }
+}
+
+
+/**
+    @brief helper function that hands an unlinked node to the reclamation scheme
+    @param self the state of this thread (inside an operation)
+    @param node the node to free once it is safe
+    @return -
+*/
+void retire(struct skipthread * self, SkipNode * node) {
+    unsigned long epoch = atomic_load(&self->epoch);
+    int slot = epoch % 3;
+
+    // the list in this slot belongs to epoch - 3 or older, it is safe to free
+    if (self->limbo[slot] != NULL && self->limbo_epoch[slot] != epoch) {
+        free_limbo(self->limbo[slot]);
+        self->limbo[slot] = NULL;
+    }
+
+    self->limbo_epoch[slot] = epoch;
+    node->limbo = self->limbo[slot];
+    self->limbo[slot] = node;
+
+    if (++self->retired % SKIP_RETIRE_BATCH == 0) try_advance(self);
+}
+
+
+/**
+    @brief helper function that drops a reference to a node (see struct skipnode)
+    @param self the state of this thread
+    @param node the node
+    @return -
+*/
+void release(struct skipthread * self, SkipNode * node) {
+    if (atomic_fetch_sub(&node->owners, 1) == 1) retire(self, node);
+}
+
+
+/**
+    @brief helper function that picks the height of a new node (geometric, p = 1/2)
+    @return a height between 1 and SKIP_MAX_LEVEL
+*/
+int random_height() {
+    // xorshift64
+    Seed ^= Seed << 13;
+    Seed ^= Seed >> 7;
+    Seed ^= Seed << 17;
+
+    int height = 1 + __builtin_ctzll(Seed | ((uint64_t)1 << (SKIP_MAX_LEVEL - 1)));
+
+    return height;
+}
+
+
+/**
+    @brief helper function that allocates a node
+    @param x the key
+    @param height the number of levels of the node
+    @return pointer to the node, NULL if allocation failed
+*/
+SkipNode * create_skipnode(Key x, int height) {
+    SkipNode * node = (SkipNode *)malloc(sizeof(SkipNode) + height * sizeof(struct skiplink));
+
+    if (node == NULL) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return NULL;
+    }
+
+    node->key = x;
+    node->height = height;
+    node->limbo = NULL;
+    atomic_init(&node->owners, 2);
+
+    for (int i = 0; i < height; i++) {
+        atomic_init(&node->level[i].next, (uintptr_t)0);
+        atomic_init(&node->level[i].span, (i == 0) ? 1 : 0);
+    }
+
+    return node;
+}
+
+
+/**
+    @brief helper function that finds the neighbours of a key at every level,
+    unlinking the deleted nodes it passes
+    @param x the key
+    @param preds filled with the last node before x at each level
+    @param succs filled with the first node at or after x at each level
+    @return 1 if a node with key x is at level 0, 0 otherwise
+*/
+int find_neighbours(Key x, SkipNode ** preds, SkipNode ** succs) {
+retry:
+    {
+        SkipNode * pred = Head;
+
+        for (int l = SKIP_MAX_LEVEL - 1; l >= 0; l--) {
+            SkipNode * curr = UNMARK(atomic_load(&pred->level[l].next));
+
+            while (curr != NULL) {
+                uintptr_t succ = atomic_load(&curr->level[l].next);
+
+                // curr has been deleted, unlink it from this level
+                while (IS_MARKED(succ)) {
+                    uintptr_t expected = (uintptr_t)curr;
+                    if (!atomic_compare_exchange_strong(&pred->level[l].next, &expected, (uintptr_t)UNMARK(succ)))
+                        goto retry;
+
+                    curr = UNMARK(succ);
+                    if (curr == NULL) break;
+                    succ = atomic_load(&curr->level[l].next);
+                }
+
+                if (curr == NULL || curr->key >= x) break;
+
+                pred = curr;
+                curr = UNMARK(succ);
+            }
+
+            preds[l] = pred;
+            succs[l] = curr;
+        }
+
+        return (succs[0] != NULL && succs[0]->key == x);
+    }
+}
+
+
+/**
+    @brief helper function that recomputes the span of a link from the spans of the level below (SpanLock held)
+    @param node the node the link starts from
+    @param l the level of the link, 1 or more
+    @return -
+*/
+void set_span(SkipNode * node, int l) {
+    SkipNode * next = UNMARK(atomic_load(&node->level[l].next));
+
+    // find() never follows a link to the end, so it needs no span
+    if (next == NULL) return;
+
+    int span = 0;
+
+    for (SkipNode * p = node; p != NULL && p != next; p = UNMARK(atomic_load(&p->level[l - 1].next)))
+        span += atomic_load(&p->level[l - 1].span);
+
+    atomic_store(&node->level[l].span, span);
+}
+
+
+/**
+    @brief helper function that recomputes the spans of every link around a key after an update
+    @details the links that skip over the key, and the links of its node if it is in the list,
+    are the only ones whose spans the update changed. They are recomputed level by level from
+    the bottom, each from the links below it (expected O(1) of them), so O(log n) in total.
+    Repairs are serialized: a link's last repair runs after every update inside it, and
+    reads links below it that are already repaired, so once the updates stop every span is exact
+    @param x the key that was inserted or deleted
+    @param node the inserted node, NULL after a delete
+    @return -
+*/
+void repair_spans(Key x, SkipNode * node) {
+    SkipNode * preds[SKIP_MAX_LEVEL];
+    SkipNode * succs[SKIP_MAX_LEVEL];
+
+    pthread_mutex_lock(&SpanLock);
+
+    find_neighbours(x, preds, succs);
+
+    for (int l = 1; l < SKIP_MAX_LEVEL; l++) {
+        set_span(preds[l], l);
+        if (node != NULL && succs[l] == node) set_span(node, l);
+    }
+
+    pthread_mutex_unlock(&SpanLock);
+}
+
+
+/**
+    @brief helper function that finds the x-th smallest key with the spans
+    @param x the rank, between 1 and the number of keys
+    @return the x-th smallest key, ERROR if the spans do not reach it
+*/
+Item find_by_spans(int x) {
+    // walk right while the link does not skip past rank x, then go down
+    SkipNode * node = Head;
+    long rank = 0;
+
+    for (int l = SKIP_MAX_LEVEL - 1; l >= 0; l--) {
+        SkipNode * next = UNMARK(atomic_load(&node->level[l].next));
+
+        while (next != NULL && rank + atomic_load(&node->level[l].span) <= x) {
+            rank += atomic_load(&node->level[l].span);
+            node = next;
+            next = UNMARK(atomic_load(&node->level[l].next));
+        }
+
+        if (rank == x) break;
+    }
+
+    return (rank == x && node != Head) ? node->key : ERROR;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+/**
+    @brief init the skip list
+    @param -
+    @return -
+*/
+void init() {
+    Head = create_skipnode(0, SKIP_MAX_LEVEL);
+
+    if (Head == NULL) exit(1);
+
+    atomic_store(&Size, 0);
+}
+
+
+/**
+    @brief count how many keys are in the skip list
+    @param -
+    @return the count of all the keys in the list
+*/
+int count() {
+    if (Head == NULL) {
+        fprintf(stderr, "Tree is not initiallized.\n");
+        return ERROR;
+    } else if (atomic_load(&Size) == 0) {
+        fprintf(stderr, "Tree is empty.\n");
+        return ERROR;
+    }
+
+    return (int)atomic_load(&Size);
+}
+
+
+/**
+    @brief insert a new Item in the skip list, safe to call from many threads
+    @param x the new Item to be inserted
+    @return none
+*/
+void insert(Item x) {
+    if (Head == NULL) {
+        fprintf(stderr, "Tree is not initiallized.\n");
+        return;
+    }
+
+    SkipNode * preds[SKIP_MAX_LEVEL];
+    SkipNode * succs[SKIP_MAX_LEVEL];
+
+    struct skipthread * self = operation_begin();
+
+    int height = random_height();
+    SkipNode * node = NULL;
+
+    // link the node at level 0, this is where the insert takes effect
+    while (1) {
+        if (find_neighbours(x, preds, succs)) {
+            free(node);
+            operation_end(self);
+            if (Verbose) fprintf(stderr, "Item has already been inserted in the Tree.\n");
+            return;
+        }
+
+        if (node == NULL) {
+            node = create_skipnode(x, height);
+            if (node == NULL) {
+                operation_end(self);
+                return;
+            }
+        }
+
+        for (int l = 0; l < height; l++) atomic_store(&node->level[l].next, (uintptr_t)succs[l]);
+
+        uintptr_t expected = (uintptr_t)succs[0];
+        if (atomic_compare_exchange_strong(&preds[0]->level[0].next, &expected, (uintptr_t)node)) break;
+    }
+
+    atomic_fetch_add(&Size, 1);
+
+    // then link it at the upper levels, unless it gets deleted in the meantime
+    for (int l = 1; l < height; l++) {
+        while (1) {
+            uintptr_t next = atomic_load(&node->level[l].next);
+            if (IS_MARKED(next)) goto linked;
+
+            // point the node to the current successor before linking it
+            if (UNMARK(next) != succs[l] &&
+                !atomic_compare_exchange_strong(&node->level[l].next, &next, (uintptr_t)succs[l]))
+                goto linked;
+
+            uintptr_t expected = (uintptr_t)succs[l];
+            if (atomic_compare_exchange_strong(&preds[l]->level[l].next, &expected, (uintptr_t)node)) break;
+
+            // the neighbours changed, look them up again
+            find_neighbours(x, preds, succs);
+            if (succs[0] != node) goto linked;
+        }
+    }
+
+linked:
+    // if the node was deleted while being linked, make sure no level still points to it
+    if (IS_MARKED(atomic_load(&node->level[0].next))) find_neighbours(x, preds, succs);
+
+    repair_spans(x, node);
+
+    release(self, node);
+    operation_end(self);
+
+    if (Verbose) printf("Inserted %d\n", x);
+}
+
+
+/**
+    @brief search if a key is inside the skip list, never waits for other threads
+    @param x key to search for
+    @return the key itself if it exists in the list, otherwise ERROR
+*/
+Item search(Key x) {
+    if (Head == NULL) {
+        fprintf(stderr, "Tree is not initiallized.\n");
+        return ERROR;
+    } else if (atomic_load(&Size) == 0) {
+        fprintf(stderr, "Tree is empty.\n");
+        return ERROR;
+    }
+
+    struct skipthread * self = operation_begin();
+
+    SkipNode * pred = Head;
+    SkipNode * curr = NULL;
+
+    // deleted nodes are walked over instead of being unlinked
+    for (int l = SKIP_MAX_LEVEL - 1; l >= 0; l--) {
+        curr = UNMARK(atomic_load(&pred->level[l].next));
+
+        while (curr != NULL && curr->key < x) {
+            pred = curr;
+            curr = UNMARK(atomic_load(&curr->level[l].next));
+        }
+    }
+
+    int found = (curr != NULL && curr->key == x && !IS_MARKED(atomic_load(&curr->level[0].next)));
+
+    operation_end(self);
+
+    return found ? x : ERROR;
+}
+
+
+/**
+    @brief remove an Item from the skip list, safe to call from many threads
+    @param x the Item to remove
+    @return -
+*/
+void delete(Item x) {
+    if (Head == NULL) {
+        fprintf(stderr, "Tree is not initiallized.\n");
+        return;
+    } else if (atomic_load(&Size) == 0) {
+        fprintf(stderr, "Tree is empty.\n");
+        return;
+    }
+
+    SkipNode * preds[SKIP_MAX_LEVEL];
+    SkipNode * succs[SKIP_MAX_LEVEL];
+
+    struct skipthread * self = operation_begin();
+
+    if (!find_neighbours(x, preds, succs)) {
+        operation_end(self);
+        if (Verbose) fprintf(stderr, "Item is not in the Tree and cannot be deleted.\n");
+        return;
+    }
+
+    SkipNode * node = succs[0];
+
+    // mark the upper levels first, so nothing new gets linked after node
+    for (int l = node->height - 1; l >= 1; l--) {
+        uintptr_t next = atomic_load(&node->level[l].next);
+        while (!IS_MARKED(next) && !atomic_compare_exchange_weak(&node->level[l].next, &next, next | 1));
+    }
+
+    // whoever marks level 0 deletes the key
+    uintptr_t next = atomic_load(&node->level[0].next);
+    while (1) {
+        if (IS_MARKED(next)) {
+            operation_end(self);
+            if (Verbose) fprintf(stderr, "Item is not in the Tree and cannot be deleted.\n");
+            return;
+        }
+        if (atomic_compare_exchange_weak(&node->level[0].next, &next, next | 1)) break;
+    }
+
+    atomic_fetch_sub(&Size, 1);
+
+    // unlink it from every level
+    find_neighbours(x, preds, succs);
+
+    repair_spans(x, NULL);
+
+    release(self, node);
+    operation_end(self);
+
+    if (Verbose) printf("Deleted %d\n", x);
+}
+
+
+/**
+    @brief find the x-th smallest element in the skip list
+    @details O(log n) with the spans (see the top of the file). Only exact if no update runs at the same time
+    @param x the wanted Item's rank based on how small it is
+    @return the x-th smallest Item in the list
+*/
+Item find(int x) {
+    if (Head == NULL) {
+        fprintf(stderr, "Tree is not initiallized.\n");
+        return ERROR;
+    } else if (atomic_load(&Size) == 0) {
+        fprintf(stderr, "Tree is empty.\n");
+        return ERROR;
+    }
+
+    if (x <= 0 || x > atomic_load(&Size)) return ERROR;
+
+    struct skipthread * self = operation_begin();
+
+    Item result = find_by_spans(x);
+
+    operation_end(self);
+
+    return result;
+}
+
+
+/**
+    @brief print the skip list level by level and then its keys in order
+    @param visit use this function to print the keys
+    @return none
+*/
+void sort(void (*visit)(Item)) {
+    if (Head == NULL) {
+        printf("Tree is not initiallized\n");
+        return;
+    } else if (atomic_load(&Size) == 0) {
+        printf("Tree is empty.\n");
+        return;
+    }
+
+    struct skipthread * self = operation_begin();
+
+    printf("\n===== SKIP LIST LEVELS =====\n");
+    for (int l = SKIP_MAX_LEVEL - 1; l >= 0; l--) {
+        SkipNode * node = UNMARK(atomic_load(&Head->level[l].next));
+        if (node == NULL) continue;
+
+        printf("[level %d] ", l);
+        for (; node != NULL; node = UNMARK(atomic_load(&node->level[l].next)))
+            if (!IS_MARKED(atomic_load(&node->level[0].next))) visit(node->key);
+        printf("\n");
+    }
+
+    printf("\n===== IN-ORDER TRAVERSAL =====\n");
+    for (SkipNode * node = UNMARK(atomic_load(&Head->level[0].next)); node != NULL;
+         node = UNMARK(atomic_load(&node->level[0].next)))
+        if (!IS_MARKED(atomic_load(&node->level[0].next))) visit(node->key);
+    printf("\n");
+
+    operation_end(self);
+}
+
+
+/**
+    @brief visit the keys in [lo, hi], in increasing order
+    @details keys inserted or deleted at the same time may or may not be visited
+    @param lo the smallest key to visit
+    @param hi the largest key to visit
+    @param visit function called for every key
+    @return the number of keys visited
+*/
+int range(Key lo, Key hi, void (*visit)(Item)) {
+    if (Head == NULL) {
+        fprintf(stderr, "Tree is not initiallized.\n");
+        return ERROR;
+    }
+
+    struct skipthread * self = operation_begin();
+
+    SkipNode * pred = Head;
+
+    // the last node before lo, same as search()
+    for (int l = SKIP_MAX_LEVEL - 1; l >= 0; l--) {
+        SkipNode * curr = UNMARK(atomic_load(&pred->level[l].next));
+
+        while (curr != NULL && curr->key < lo) {
+            pred = curr;
+            curr = UNMARK(atomic_load(&curr->level[l].next));
+        }
+    }
+
+    int visited = 0;
+
+    for (SkipNode * node = UNMARK(atomic_load(&pred->level[0].next)); node != NULL && node->key <= hi;
+         node = UNMARK(atomic_load(&node->level[0].next))) {
+        if (!IS_MARKED(atomic_load(&node->level[0].next))) {
+            visit(node->key);
+            visited++;
+        }
+    }
+
+    operation_end(self);
+
+    return visited;
+}
+
+
+/**
+    @brief frees the skip list, no other thread may be using it
+    @param -
+    @return -
+*/
+void destroy() {
+    if (Head == NULL) {
+        fprintf(stderr, "Tree is not initiallized.\n");
+        return;
+    }
+
+    // every node still at level 0 (deleted or not) has not been retired
+    SkipNode * node = UNMARK(atomic_load(&Head->level[0].next));
+    while (node != NULL) {
+        SkipNode * next = UNMARK(atomic_load(&node->level[0].next));
+        free(node);
+        node = next;
+    }
+    free(Head);
+    Head = NULL;
+
+    int threads = atomic_load(&ThreadCount);
+    for (int i = 0; i < threads && i < SKIP_MAX_THREADS; i++) {
+        for (int e = 0; e < 3; e++) {
+            free_limbo(Threads[i].limbo[e]);
+            Threads[i].limbo[e] = NULL;
+        }
+    }
+
+    pthread_mutex_lock(&OrphanLock);
+    for (int e = 0; e < 3; e++) {
+        free_limbo(Orphans[e]);
+        Orphans[e] = NULL;
+    }
+    pthread_mutex_unlock(&OrphanLock);
+}
+
+
+/**
+    @brief turn the per-operation messages of insert() and delete() on or off
+    @param on 1 to print the messages (default), 0 to stay quiet
+    @return -
+*/
+void verbose(int on) {
+    Verbose = on;
+}
+
+#endif
@@ -11,11 +11,31 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "Tree24Interface.h"
+#include "BloomInterface.h"
+#include "HashIndexInterface.h"
+#include "WalInterface.h"
 
 
 // set the tree as a global variable
 Tree24 * T;
 
+// print a message for every insert() and delete() (see verbose())
+int Verbose = 1;
+
+// optional Bloom filter kept alongside the tree, NULL while disabled
+BloomFilter * Filter = NULL;
+
+// deletes since the filter was last rebuilt (deleted keys stay in the filter)
+int FilterDeletes = 0;
+
+// set once the filter holds too many deleted keys or more keys than
+// it was sized for. It is rebuilt lazily on the next search()
+int FilterStale = 0;
+
+// optional hash table mapping every key to the node that contains it,
+// NULL while disabled. Every key move in insert() and delete() updates it
+HashIndex * Index = NULL;
+
 
 void newline() {
     printf("\n");
@@ -156,6 +176,281 @@ void in_order(Tree24 * node) {
     }
 }
 
+/**
+    @brief helper function that adds every key of a subtree to the Bloom filter
+    @param node the root of the subtree
+    @return -
+*/
+void filter_fill(Tree24 * node) {
+    if (node == NULL) return;
+
+    for (int i = 0; i < node->Count; i++) bloom_add(Filter, node->items[i]);
+
+    for (int i = 0; i <= node->Count; i++) filter_fill(node->children[i]);
+}
+
+/**
+    @brief helper function that rebuilds the Bloom filter from the keys currently in the tree
+    @details the new filter is sized for twice the current keys, so it can absorb
+    that many inserts before it has to be rebuilt again. Statistics are kept.
+    @return -
+*/
+void filter_rebuild() {
+    BloomFilter * NewFilter = bloom_create(2 * count_recursive(T), Filter->bits_per_key);
+
+    // keep using the old filter if there is no memory, it only gives more false positives
+    if (NewFilter == NULL) return;
+
+    NewFilter->negatives = Filter->negatives;
+    NewFilter->true_positives = Filter->true_positives;
+    NewFilter->false_positives = Filter->false_positives;
+
+    bloom_destroy(Filter);
+    Filter = NewFilter;
+
+    filter_fill(T);
+
+    FilterDeletes = 0;
+    FilterStale = 0;
+}
+
+/**
+    @brief helper function that adds every key of a subtree to the hash index
+    @param node the root of the subtree
+    @return 0 on success, -1 if the index could not grow
+*/
+int index_fill(Tree24 * node) {
+    if (node == NULL) return 0;
+
+    for (int i = 0; i < node->Count; i++)
+        if (hash_put(Index, node->items[i], node) != 0) return -1;
+
+    for (int i = 0; i <= node->Count; i++)
+        if (index_fill(node->children[i]) != 0) return -1;
+
+    return 0;
+}
+
+/**
+    @brief helper function that records the node of a key in the hash index, if it is enabled
+    @details an index that could not grow would miss keys that are in the tree and make
+    search() answer wrongly, so it is dropped and search() goes back to descending the tree
+    @param x the key
+    @param node the node that contains x
+    @return -
+*/
+void index_put(Key x, Tree24 * node) {
+    if (Index != NULL && hash_put(Index, x, node) != 0) disable_index();
+}
+
+/**
+    @brief helper function that counts the nodes of a subtree
+    @param node the root of the subtree
+    @return the number of nodes
+*/
+int count_nodes(Tree24 * node) {
+    if (node == NULL) return 0;
+
+    int nodes = 1;
+
+    for (int i = 0; i <= node->Count; i++) nodes += count_nodes(node->children[i]);
+
+    return nodes;
+}
+
+// every node has at least 2 children, so 64 levels are more than any tree can have
+#define MAX_HEIGHT 64
+
+// state of a non-recursive in-order traversal:
+// a stack of nodes and the next key to visit in each of them
+struct tree_iterator {
+    Tree24 * node[MAX_HEIGHT];
+    int index[MAX_HEIGHT];
+    int depth;
+
+    // nodes whose keys have all been visited are handed over here (may be NULL)
+    Tree24 ** done;
+    int ndone;
+};
+
+/**
+    @brief helper function that pushes a node and its left-most path on the traversal stack
+    @param it the traversal
+    @param node the node to start from
+    @return -
+*/
+void iterator_descend(struct tree_iterator * it, Tree24 * node) {
+    while (node != NULL) {
+        it->depth++;
+        it->node[it->depth] = node;
+        it->index[it->depth] = 0;
+        node = node->children[0];
+    }
+}
+
+/**
+    @brief helper function that starts an in-order traversal of a subtree
+    @param it the traversal
+    @param root the root of the subtree
+    @param done array to collect the visited nodes in, NULL to not collect them
+    @return -
+*/
+void iterator_init(struct tree_iterator * it, Tree24 * root, Tree24 ** done) {
+    it->depth = -1;
+    it->done = done;
+    it->ndone = 0;
+
+    iterator_descend(it, root);
+}
+
+/**
+    @brief helper function that moves an in-order traversal to the next key
+    @param it the traversal
+    @param x where to store the key
+    @return 1 if a key was stored in x, 0 when the traversal is over
+*/
+int iterator_next(struct tree_iterator * it, Item * x) {
+    while (it->depth >= 0) {
+        Tree24 * node = it->node[it->depth];
+        int i = it->index[it->depth];
+
+        if (i < node->Count) {
+            *x = node->items[i];
+            it->index[it->depth]++;
+
+            // the keys after items[i] are in children[i + 1]
+            iterator_descend(it, node->children[i + 1]);
+            return 1;
+        }
+
+        it->depth--;
+        if (it->done != NULL) it->done[it->ndone++] = node;
+    }
+
+    return 0;
+}
+
+/**
+    @brief helper function that takes a node from a pool of unused nodes, or allocates a new one
+    @param pool the unused nodes
+    @param pooled the number of nodes in the pool, decreased if one is taken
+    @return an empty node
+*/
+Tree24 * reuse_node(Tree24 ** pool, int * pooled) {
+    if (*pooled == 0) {
+        Tree24 * node = create_node();
+
+        // same as init(), a half built tree cannot be recovered
+        if (node == NULL) exit(1);
+
+        return node;
+    }
+
+    Tree24 * node = pool[--(*pooled)];
+
+    node->Count = 0;
+    node->parent = NULL;
+
+    for (int i = 0; i < 4; i++) node->items[i] = EMPTY;
+
+    for (int i = 0; i < 5; i++) {
+        node->children[i] = NULL;
+        node->N[i] = 0;
+    }
+
+    return node;
+}
+
+/**
+    @brief helper function that builds a (2, 4) Tree bottom-up from sorted, distinct keys in O(n)
+    @details the keys are spread evenly over as few leaves as possible (1 to 3 keys each),
+    the keys between the leaves move up a level and are grouped the same way,
+    until a level has a single node. Every leaf ends up at the same depth.
+    @param keys the keys in increasing order
+    @param n the number of keys
+    @param pool nodes that can be reused instead of allocating new ones (may be NULL),
+    the nodes of the pool that are not needed are freed
+    @param pooled the number of nodes in the pool
+    @return the root of the new tree, NULL if allocation failed
+*/
+Tree24 * bulk_build(Item * keys, int n, Tree24 ** pool, int pooled) {
+    if (n <= 0) {
+        Tree24 * root = reuse_node(pool, &pooled);
+        while (pooled > 0) free(pool[--pooled]);
+        return root;
+    }
+
+    // leaves: as few as possible, each one has 1 to 3 keys
+    int level_n = (n + 4) / 4;
+
+    Tree24 ** level = (Tree24 **)malloc(level_n * sizeof(Tree24 *));
+    int * sizes = (int *)malloc(level_n * sizeof(int));
+    Item * seps = (Item *)malloc(level_n * sizeof(Item));
+
+    if (!level || !sizes || !seps) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(level);
+        free(sizes);
+        free(seps);
+        return NULL;
+    }
+
+    int leaf_keys = n - (level_n - 1);
+    int next = 0;
+
+    for (int j = 0; j < level_n; j++) {
+        Tree24 * leaf = reuse_node(pool, &pooled);
+
+        leaf->Count = leaf_keys / level_n + (j < leaf_keys % level_n);
+        for (int i = 0; i < leaf->Count; i++) leaf->items[i] = keys[next++];
+
+        level[j] = leaf;
+        sizes[j] = leaf->Count;
+
+        // the key between this leaf and the next one goes up a level
+        if (j < level_n - 1) seps[j] = keys[next++];
+    }
+
+    // group the nodes of each level under parents with 2 to 4 children
+    while (level_n > 1) {
+        int parents = (level_n + 3) / 4;
+        int child = 0;
+
+        for (int j = 0; j < parents; j++) {
+            Tree24 * parent = reuse_node(pool, &pooled);
+
+            int children = level_n / parents + (j < level_n % parents);
+            int size = 0;
+
+            for (int i = 0; i < children; i++, child++) {
+                parent->children[i] = level[child];
+                parent->N[i] = sizes[child];
+                level[child]->parent = parent;
+                size += sizes[child];
+
+                if (i < children - 1) parent->items[parent->Count++] = seps[child];
+            }
+
+            // parents are written over the level below, which has been used up to here
+            level[j] = parent;
+            sizes[j] = size + parent->Count;
+            if (j < parents - 1) seps[j] = seps[child - 1];
+        }
+
+        level_n = parents;
+    }
+
+    Tree24 * root = level[0];
+
+    free(level);
+    free(sizes);
+    free(seps);
+
+    while (pooled > 0) free(pool[--pooled]);
+
+    return root;
+}
+
 /**
     @brief function passed on to other functions to print the keys in a node.
     @details using the function provided if lab-5
@@ -240,7 +535,7 @@ void insert(Item x) {
         for (int i = 0; i < T->Count; i++) {
             
             if (x == T->items[i]) {
-                fprintf(stderr, "Item has already been inserted in the Tree.\n");
+                if (Verbose) fprintf(stderr, "Item has already been inserted in the Tree.\n");
                 T = OriginalTree;
                 return;
             } else if (x < T->items[i]) {
@@ -264,11 +559,11 @@ void insert(Item x) {
     // so now we need to search if x is in this node
     // otherwise, insert x here.
 
-    int position;
+    int position = 0;
 
     for (int i = 0; i < T->Count; i++) {
         if (x == T->items[i]) {
-            fprintf(stderr, "Item has already been inserted in the Tree.\n");
+            if (Verbose) fprintf(stderr, "Item has already been inserted in the Tree.\n");
             T = OriginalTree;
             return;
         } else if (x < T->items[i]) {
@@ -291,11 +586,20 @@ void insert(Item x) {
     }
 
 
+    wal_append(WAL_INSERT, x);
+
     // shift items to make room for the new key
     for (int i = T->Count; i > position; i--) T->items[i] = T->items[i - 1];
     T->items[position] = x;
     T->Count++;
 
+    if (Filter != NULL) {
+        bloom_add(Filter, x);
+        if (Filter->keys > Filter->capacity) FilterStale = 1;
+    }
+
+    index_put(x, T);
+
 
     // check for overflow
     while (T->Count > 3) {
@@ -313,6 +617,7 @@ void insert(Item x) {
 
         // move the fourth key and the last two children to the new node
         NewNode->items[0] = CurrentNode->items[3];
+        index_put(NewNode->items[0], NewNode);
         NewNode->children[0] = CurrentNode->children[3];
         NewNode->children[1] = CurrentNode->children[4];
 
@@ -352,6 +657,7 @@ void insert(Item x) {
             NewRoot->Count = 1;
 
             NewRoot->items[0] = CurrentNode->items[2];
+            index_put(NewRoot->items[0], NewRoot);
 
             NewRoot->parent = NULL;
             
@@ -388,22 +694,22 @@ void insert(Item x) {
             // also add the parent of the new node to be T
             NewNode->parent = T;
 
-            // now add the third key to the parent node
-            for (int i = T->Count; i >= 0; i--) {
-                
+            // now add the third key to the parent node,
+            // shifting the larger keys one position to the right
+            int i = T->Count;
+            while (i > 0 && T->items[i - 1] > CurrentNode->items[2]) {
                 T->items[i] = T->items[i - 1];
-                if (CurrentNode->items[2] > T->items[i - 1]) {
-                    T->items[i] = CurrentNode->items[2];
-                    break;
-                }
+                i--;
             }
+            T->items[i] = CurrentNode->items[2];
+            index_put(T->items[i], T);
 
             // update counts for T and Current Node
             T->Count++;
             CurrentNode->Count--;
 
             // contains CurrentNode's position in T's children
-            int position;
+            int position = 0;
 
             // also add NewNode as a child for T
             for (int i = T->Count - 1; i >= 0; i--) {
@@ -437,7 +743,7 @@ void insert(Item x) {
     // restore tree to its original state before returning
     T = OriginalTree;
     
-    printf("Inserted %d\n", x);
+    if (Verbose) printf("Inserted %d\n", x);
 
     return;
 
@@ -458,6 +764,20 @@ Item search(Key x) {
         return ERROR;
     }
 
+    // with the hash index enabled a point lookup is a single probe
+    if (Index != NULL) return (hash_lookup(Index, x) != NULL) ? x : ERROR;
+
+    // keys the filter has never seen are not in the tree,
+    // so answer them without descending
+    if (Filter != NULL) {
+        if (FilterStale) filter_rebuild();
+
+        if (!bloom_may_contain(Filter, x)) {
+            Filter->negatives++;
+            return ERROR;
+        }
+    }
+
     Tree24 * OriginalTree = T;
 
     // find which child to follow
@@ -470,6 +790,7 @@ Item search(Key x) {
         for (int i = 0; i < T->Count; i++) {
             if (x == T->items[i]) {
                 T = OriginalTree;
+                if (Filter != NULL) Filter->true_positives++;
                 return x;
             } else if (x < T->items[i]) {
                 T = T->children[i];
@@ -487,6 +808,7 @@ Item search(Key x) {
     for (int i = 0; i < T->Count; i++)  {
         if (x == T->items[i])  {
             T = OriginalTree;
+            if (Filter != NULL) Filter->true_positives++;
             return x;
         }
     }
@@ -495,6 +817,7 @@ Item search(Key x) {
     // at this point, the Item isn't in the Tree, so 
     // restore and return error
     T = OriginalTree;
+    if (Filter != NULL) Filter->false_positives++;
     return ERROR;
 
 }
@@ -551,12 +874,20 @@ void delete(Item x) {
     
     // if position is still -1, then the item is not in the tree and cannot be removed
     if (position == -1) {
-        fprintf(stderr, "Item is not in the Tree and cannot be deleted.\n");
+        if (Verbose) fprintf(stderr, "Item is not in the Tree and cannot be deleted.\n");
         // restore tree to its original state berfore returning
         T = OriginalTree;
         return;
     }
 
+    wal_append(WAL_DELETE, x);
+
+    // x stays in the filter, so once enough keys have been
+    // deleted the filter is rebuilt to get rid of them
+    if (Filter != NULL && ++FilterDeletes > Filter->keys / 2) FilterStale = 1;
+
+    if (Index != NULL) hash_remove(Index, x);
+
     
     // determine if the node containing x is a leaf node or not
     // since each case follows a different process
@@ -578,6 +909,7 @@ void delete(Item x) {
         // replace the deleting value with the highest one in T
         
         CurrentNode->items[position] = T->items[--T->Count];
+        index_put(CurrentNode->items[position], CurrentNode);
         
         flag = 1;
     }
@@ -603,8 +935,14 @@ void delete(Item x) {
             
         // if the root has been reached, delete it
         if (CurrentNode == OriginalTree) {
+            // deleting the last key leaves an empty tree, not an uninitialized one
+            if (CurrentNode->children[0] == NULL) {
+                T = CurrentNode;
+                return;
+            }
+
             T = CurrentNode->children[0];
-            if (T) T->parent = NULL;
+            T->parent = NULL;
             free(OriginalTree);
             return;
         }
@@ -616,6 +954,8 @@ void delete(Item x) {
             if (CurrentNode == T->children[i])
                 position = i;
 
+        // an empty node keeps a single child (NULL for leaves),
+        // which has to follow it through the transfer or the fusion
             
         if (position > 0) {
             //check if the left sibling of CurrentNode is a 3-node or a 4-node
@@ -634,12 +974,18 @@ void delete(Item x) {
                 // finally add the parent key to the new node
                 CurrentNode->items[0] = transfering_key;
 
-                // no need to edit the children since a sibling of CurrentNode cannot have 
-                // internal child nodes, due to the special properties of the 2-3-4 Trees
+                // the right-most child of TransferingNode becomes the first child of CurrentNode
+                CurrentNode->children[1] = CurrentNode->children[0];
+                CurrentNode->children[0] = TransferingNode->children[TransferingNode->Count];
+                TransferingNode->children[TransferingNode->Count] = NULL;
+                if (CurrentNode->children[0]) CurrentNode->children[0]->parent = CurrentNode;
 
                 // update the counts
                 CurrentNode->Count++;
                 TransferingNode->Count--;
+
+                index_put(T->items[position - 1], T);
+                index_put(CurrentNode->items[0], CurrentNode);
             } else {
                 // if T->children[position - 1]->Count isn't equal or greater than 2, it must be 1
                 // in this case we perform a fusion operation
@@ -652,8 +998,11 @@ void delete(Item x) {
                 FusionNode->items[FusionNode->Count++] = T->items[position - 1];
                 T->Count--;
 
+                index_put(FusionNode->items[FusionNode->Count - 1], FusionNode);
+
                 // don't forget to copy the children
                 FusionNode->children[FusionNode->Count] = CurrentNode->children[0];
+                if (CurrentNode->children[0]) CurrentNode->children[0]->parent = FusionNode;
 
                 // shift items in T
                 for (int i = position - 1; i < T->Count; i++) T->items[i] = T->items[i + 1];
@@ -667,7 +1016,7 @@ void delete(Item x) {
                 free(CurrentNode);
             }
                 
-        } else if (position <= T->Count - 1) {
+        } else {
             if (T->children[position + 1]->Count >= 2) {
 
                 Tree24 * TransferingNode = T->children[position + 1];
@@ -676,12 +1025,22 @@ void delete(Item x) {
 
                 // take the first key from TransferingNode and shift the items
                 T->items[position] = TransferingNode->items[0];
+
+                // the first child of TransferingNode becomes the second child of CurrentNode
+                CurrentNode->children[1] = TransferingNode->children[0];
+                if (CurrentNode->children[1]) CurrentNode->children[1]->parent = CurrentNode;
+
                 TransferingNode->Count--;
                 for (int i = 0; i < TransferingNode->Count; i++) TransferingNode->items[i] = TransferingNode->items[i+1];
+                for (int i = 0; i <= TransferingNode->Count; i++) TransferingNode->children[i] = TransferingNode->children[i+1];
+                TransferingNode->children[TransferingNode->Count + 1] = NULL;
 
                 CurrentNode->items[0] = transfering_key;
 
                 CurrentNode->Count++;
+
+                index_put(T->items[position], T);
+                index_put(CurrentNode->items[0], CurrentNode);
             } else {
                 // if T->children[position - 1]->Count isn't equal or greater than 2, it must be 1
                 // in this case we perform a fusion operation
@@ -697,6 +1056,17 @@ void delete(Item x) {
                 CurrentNode->items[1] = FusionNode->items[0];
                 CurrentNode->Count++;
 
+                // and both children of FusionNode
+                CurrentNode->children[1] = FusionNode->children[0];
+                CurrentNode->children[2] = FusionNode->children[1];
+                if (CurrentNode->children[1]) {
+                    CurrentNode->children[1]->parent = CurrentNode;
+                    CurrentNode->children[2]->parent = CurrentNode;
+                }
+
+                index_put(CurrentNode->items[0], CurrentNode);
+                index_put(CurrentNode->items[1], CurrentNode);
+
                     
                 T->Count--;
 
@@ -714,7 +1084,7 @@ void delete(Item x) {
     }
     T = OriginalTree;
     
-    printf("Deleted %d\n", x);
+    if (Verbose) printf("Deleted %d\n", x);
 
     return;
     
@@ -840,6 +1210,52 @@ void sort(void (*visit)(Item)) {
 }
 
 
+/**
+    @brief helper function that visits the keys of a subtree that are in [lo, hi], in order
+    @param node the root of the subtree
+    @param lo the smallest key to visit
+    @param hi the largest key to visit
+    @param visit function called for every key
+    @return the number of keys visited
+*/
+int range_helper(Tree24 * node, Key lo, Key hi, void (*visit)(Item)) {
+    if (node == NULL) return 0;
+
+    int visited = 0;
+
+    for (int i = 0; i <= node->Count; i++) {
+        // children[i] holds the keys between items[i - 1] and items[i]
+        if (i == node->Count || node->items[i] > lo) visited += range_helper(node->children[i], lo, hi, visit);
+
+        if (i == node->Count || node->items[i] > hi) break;
+
+        if (node->items[i] >= lo) {
+            visit(node->items[i]);
+            visited++;
+        }
+    }
+
+    return visited;
+}
+
+
+/**
+    @brief visit the keys of the (2, 4) Tree in [lo, hi], in increasing order
+    @param lo the smallest key to visit
+    @param hi the largest key to visit
+    @param visit function called for every key
+    @return the number of keys visited
+*/
+int range(Key lo, Key hi, void (*visit)(Item)) {
+    if (T == NULL) {
+        fprintf(stderr, "Tree is not initiallized.\n");
+        return ERROR;
+    }
+
+    return range_helper(T, lo, hi, visit);
+}
+
+
 /**
     @brief frees a (2, 4) Tree
     @param -
@@ -853,6 +1269,241 @@ void destroy() {
     
     destroyNode(T);
     T = NULL;
+
+    disable_filter();
+    disable_index();
+}
+
+
+/**
+    @brief turn the per-operation messages of insert() and delete() on or off
+    @details benchmarks and servers turn them off, errors are still reported
+    @param on 1 to print the messages (default), 0 to stay quiet
+    @return -
+*/
+void verbose(int on) {
+    Verbose = on;
+}
+
+
+/**
+    @brief enable (or resize) the Bloom filter used by search() to answer misses
+    @param bits_per_key bits to spend per key, 0 for BLOOM_DEFAULT_BITS_PER_KEY
+    @return -
+*/
+void enable_filter(int bits_per_key) {
+    BloomFilter * NewFilter = bloom_create(2 * count_recursive(T), bits_per_key);
+
+    if (NewFilter == NULL) return;
+
+    bloom_destroy(Filter);
+    Filter = NewFilter;
+
+    filter_fill(T);
+
+    FilterDeletes = 0;
+    FilterStale = 0;
+}
+
+
+/**
+    @brief disable the Bloom filter and free its memory
+    @param -
+    @return -
+*/
+void disable_filter() {
+    bloom_destroy(Filter);
+    Filter = NULL;
+
+    FilterDeletes = 0;
+    FilterStale = 0;
+}
+
+
+/**
+    @brief print how well the Bloom filter has been doing
+    @param -
+    @return -
+*/
+void filter_stats() {
+    if (Filter == NULL) {
+        printf("Filter is not enabled.\n");
+        return;
+    }
+
+    long misses = Filter->negatives + Filter->false_positives;
+    long lookups = misses + Filter->true_positives;
+
+    printf("Filter: %d keys, %d bits/key, %d hashes, %ld bytes\n", Filter->keys, Filter->bits_per_key,
+           Filter->k, (long)Filter->nblocks * BLOOM_BLOCK_WORDS * (long)sizeof(uint64_t));
+    printf("Lookups: %ld, filtered out: %ld, true positives: %ld, false positives: %ld\n",
+           lookups, Filter->negatives, Filter->true_positives, Filter->false_positives);
+
+    // the false positive rate is measured over the keys that were not in the tree
+    if (misses > 0) printf("False positive rate: %.4f\n", (double)Filter->false_positives / misses);
+}
+
+
+/**
+    @brief enable the hash index, so that search() answers with a single probe
+    @details find(), sort() and every other ordered operation keep using the tree
+    @param -
+    @return -
+*/
+void enable_index() {
+    HashIndex * NewIndex = hash_create(count_recursive(T));
+
+    if (NewIndex == NULL) return;
+
+    hash_destroy(Index);
+    Index = NewIndex;
+
+    if (index_fill(T) != 0) disable_index();
+}
+
+
+/**
+    @brief disable the hash index and free its memory
+    @param -
+    @return -
+*/
+void disable_index() {
+    hash_destroy(Index);
+    Index = NULL;
+}
+
+
+/**
+    @brief print the memory used by the hash index next to the memory used by the tree
+    @param -
+    @return -
+*/
+void index_stats() {
+    if (Index == NULL) {
+        printf("Index is not enabled.\n");
+        return;
+    }
+
+    long tree_bytes = (long)count_nodes(T) * (long)sizeof(struct t24);
+    long index_bytes = hash_memory(Index);
+
+    printf("Index: %d keys, %d slots, %ld bytes (%.1f bytes/key)\n", Index->size, Index->capacity,
+           index_bytes, Index->size ? (double)index_bytes / Index->size : 0.0);
+    printf("Tree: %ld bytes, index overhead: %.1f%%\n", tree_bytes,
+           tree_bytes ? 100.0 * index_bytes / tree_bytes : 0.0);
+}
+
+
+/**
+    @brief find the node of the (2, 4) Tree that contains a key
+    @param x the key to look for
+    @return the node containing x, NULL if x is not in the Tree
+*/
+Tree24 * locate(Key x) {
+    if (T == NULL || T->Count == 0) return NULL;
+
+    if (Index != NULL) return hash_lookup(Index, x);
+
+    Tree24 * node = T;
+
+    while (node != NULL) {
+        int i = 0;
+        while (i < node->Count && x > node->items[i]) i++;
+
+        if (i < node->Count && x == node->items[i]) return node;
+
+        node = node->children[i];
+    }
+
+    return NULL;
+}
+
+
+/**
+    @brief build a (2, 4) Tree from keys that are already sorted, in O(n)
+    @param keys distinct keys in increasing order
+    @param n the number of keys
+    @return the root of the new tree (empty if n is 0), the global tree is not changed
+*/
+Tree24 * build_sorted(Item * keys, int n) {
+    return bulk_build(keys, n, NULL, 0);
+}
+
+
+/**
+    @brief merge two (2, 4) Trees into one in O(m + n)
+    @details both trees are read in order by a non-recursive traversal, the two
+    sequences are merged (keys found in both trees are kept once) and the result
+    is built bottom-up, reusing the nodes of the two trees. If one of them is the
+    global tree, the global tree becomes the result (and the Bloom filter and hash
+    index are rebuilt).
+    @param a the root of the first tree, not usable after the call
+    @param b the root of the second tree (a different tree), not usable after the call
+    @return the root of the merged tree
+*/
+Tree24 * merge(Tree24 * a, Tree24 * b) {
+    int na = count_recursive(a);
+    int nb = count_recursive(b);
+    int nodes_a = count_nodes(a);
+    int nodes_b = count_nodes(b);
+
+    Item * keys = (Item *)malloc((na + nb + 1) * sizeof(Item));
+    Tree24 ** pool = (Tree24 **)malloc((nodes_a + nodes_b + 1) * sizeof(Tree24 *));
+
+    if (!keys || !pool) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(keys);
+        free(pool);
+        return NULL;
+    }
+
+    // the nodes of both trees are collected in pool as the traversals leave them
+    struct tree_iterator ia, ib;
+    iterator_init(&ia, a, pool);
+    iterator_init(&ib, b, pool + nodes_a);
+
+    Item x, y;
+    int has_x = iterator_next(&ia, &x);
+    int has_y = iterator_next(&ib, &y);
+    int n = 0;
+
+    while (has_x && has_y) {
+        if (x < y) {
+            keys[n++] = x;
+            has_x = iterator_next(&ia, &x);
+        } else if (y < x) {
+            keys[n++] = y;
+            has_y = iterator_next(&ib, &y);
+        } else {
+            keys[n++] = x;
+            has_x = iterator_next(&ia, &x);
+            has_y = iterator_next(&ib, &y);
+        }
+    }
+
+    while (has_x) {
+        keys[n++] = x;
+        has_x = iterator_next(&ia, &x);
+    }
+
+    while (has_y) {
+        keys[n++] = y;
+        has_y = iterator_next(&ib, &y);
+    }
+
+    Tree24 * root = bulk_build(keys, n, pool, nodes_a + nodes_b);
+
+    free(keys);
+    free(pool);
+
+    if (root != NULL && T != NULL && (a == T || b == T)) {
+        T = root;
+
+        if (Filter != NULL) enable_filter(Filter->bits_per_key);
+        if (Index != NULL) enable_index();
+    }
+
+    return root;
 }
 
 #endif
\ No newline at end of file
@@ -42,8 +42,29 @@ Item search(Key);
 void delete(Item);
 Item find(int); // select was renamed as find because of confinct with the GNU C library 
 void sort(void (*visit)(Item));
+int range(Key, Key, void (*visit)(Item));
 
 void destroy();
 
+void verbose(int);
+
+// optional Bloom filter in front of search() (see BloomInterface.h)
+void enable_filter(int);
+void disable_filter();
+void filter_stats();
+
+// optional hash index (key -> node) used by search() (see HashIndexInterface.h)
+void enable_index();
+void disable_index();
+void index_stats();
+Tree24 * locate(Key);
+
+// bulk operations, O(n) instead of n calls to insert()
+Tree24 * build_sorted(Item *, int);
+Tree24 * merge(Tree24 *, Tree24 *);
+
+// bulk build from unsorted keys with many threads (see ParallelBuildImplementation.c)
+Tree24 * parallel_build(Item *, int, int);
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,476 @@
+/**
+    @file WalImplementation.c
+    @author Anastasia Marinakou | sdi2400120
+    @details Course: Data Structures and Programming Techniques (Even) - 2025
+    @brief Operation log (write-ahead log) and checkpoints for the global (2, 4) Tree
+    @details insert() and delete() append a record for every operation that changes the
+    tree. Records are written and fsync()'ed in groups, so a crash loses at most the
+    last group. A checkpoint writes every key of the tree to a new file, renames it
+    over the old one, fsync()s the directory (so the rename is on disk) and only then
+    empties the log, so recovery only has to load the checkpoint (with build_sorted())
+    and replay the operations logged after it.
+
+    Replaying a log on a checkpoint that already contains some of its operations
+    gives the same tree (the last operation on each key wins), so a crash between
+    renaming the checkpoint and emptying the log is harmless.
+*/
+
+#ifndef WALIMPLEMENTATION_C
+#define WALIMPLEMENTATION_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "WalInterface.h"
+
+// the global tree and its message switch, from Tree24Implementation.c
+extern Tree24 * T;
+extern int Verbose;
+
+// keys written or read with a single system call during checkpoints and recovery
+#define WAL_BUFFER 65536
+
+int LogFd = -1;
+char * LogPath = NULL;
+char * CheckpointPath = NULL;
+
+// records waiting for the next group commit
+WalRecord * Pending = NULL;
+int PendingCount = 0;
+int GroupSize = WAL_DEFAULT_GROUP;
+
+// automatic checkpoints: one every CheckpointEvery records (0 to disable)
+int CheckpointEvery = 0;
+long SinceCheckpoint = 0;
+int CheckpointDue = 0;
+
+// automatic checkpoints that failed since the last checkpoint that succeeded
+int FailedCheckpoints = 0;
+
+// set while recover() replays the log, so the replayed operations are not logged again
+int Replaying = 0;
+
+
+/**
+    @brief helper function that writes a whole buffer, retrying on short writes
+    @param fd the file
+    @param buffer the data
+    @param size the number of bytes
+    @return 0 on success, -1 on error
+*/
+int write_all(int fd, const void * buffer, size_t size) {
+    const char * p = (const char *)buffer;
+
+    while (size > 0) {
+        ssize_t written = write(fd, p, size);
+        if (written < 0) return -1;
+        p += written;
+        size -= written;
+    }
+
+    return 0;
+}
+
+
+/**
+    @brief helper function that duplicates a string
+    @param s the string
+    @return a malloc'd copy of s, NULL if allocation failed
+*/
+char * copy_string(const char * s) {
+    char * copy = (char *)malloc(strlen(s) + 1);
+
+    if (copy == NULL) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return NULL;
+    }
+
+    strcpy(copy, s);
+    return copy;
+}
+
+
+/**
+    @brief helper function that waits until the directory entries of a file are on disk
+    @details a rename() is only durable once the directory that contains the file is fsync()'ed
+    @param path the file
+    @return 0 on success, -1 on error
+*/
+int sync_directory(const char * path) {
+    char * dir = copy_string(path);
+    if (dir == NULL) return -1;
+
+    // a path without '/' is in the current directory
+    const char * name = dir;
+    char * slash = strrchr(dir, '/');
+
+    if (slash == NULL) name = ".";
+    else if (slash == dir) slash[1] = '\0';
+    else slash[0] = '\0';
+
+    int fd = open(name, O_RDONLY);
+    int result = (fd == -1 || fsync(fd) != 0) ? -1 : 0;
+
+    if (result != 0) perror(name);
+    if (fd != -1) close(fd);
+
+    free(dir);
+    return result;
+}
+
+
+// output buffer of the checkpoint being written
+struct checkpoint_writer {
+    int fd;
+    Item * keys;
+    int count;
+    int error;
+};
+
+/**
+    @brief helper function that writes the keys of a subtree in order to a checkpoint
+    @param w the checkpoint being written
+    @param node the root of the subtree
+    @return -
+*/
+void write_keys(struct checkpoint_writer * w, Tree24 * node) {
+    if (node == NULL || w->error) return;
+
+    for (int i = 0; i <= node->Count; i++) {
+        write_keys(w, node->children[i]);
+
+        if (i < node->Count) {
+            w->keys[w->count++] = node->items[i];
+
+            if (w->count == WAL_BUFFER) {
+                if (write_all(w->fd, w->keys, w->count * sizeof(Item)) != 0) w->error = 1;
+                w->count = 0;
+            }
+        }
+    }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+/**
+    @brief start logging the operations of the global tree
+    @param log_path the operation log, created if needed and appended to
+    @param checkpoint_path where checkpoint() writes the tree
+    @param group records written with one fsync() (0 for WAL_DEFAULT_GROUP)
+    @param checkpoint_every take a checkpoint every this many records (0 to only checkpoint on request)
+    @return 0 on success, -1 on error
+*/
+int wal_open(const char * log_path, const char * checkpoint_path, int group, int checkpoint_every) {
+    if (LogFd != -1) wal_close();
+
+    if (group <= 0) group = WAL_DEFAULT_GROUP;
+
+    LogFd = open(log_path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+    if (LogFd == -1) {
+        perror(log_path);
+        return -1;
+    }
+
+    LogPath = copy_string(log_path);
+    CheckpointPath = copy_string(checkpoint_path);
+    Pending = (WalRecord *)malloc(group * sizeof(WalRecord));
+
+    if (!LogPath || !CheckpointPath || !Pending) {
+        wal_close();
+        return -1;
+    }
+
+    GroupSize = group;
+    PendingCount = 0;
+    CheckpointEvery = checkpoint_every;
+    SinceCheckpoint = 0;
+    CheckpointDue = 0;
+    FailedCheckpoints = 0;
+
+    return 0;
+}
+
+
+/**
+    @brief log an operation, called by insert() and delete() before they change the tree
+    @param op WAL_INSERT or WAL_DELETE
+    @param x the key
+    @return -
+*/
+void wal_append(int op, Key x) {
+    if (LogFd == -1 || Replaying) return;
+
+    // a checkpoint that became due with the previous record is taken now,
+    // when the tree contains every operation logged so far
+    if (CheckpointDue && checkpoint() != 0) {
+        // retrying on every record would dump the whole tree on every update
+        // while the disk keeps failing, so wait for another CheckpointEvery records
+        FailedCheckpoints++;
+        SinceCheckpoint = 0;
+        CheckpointDue = 0;
+        fprintf(stderr, "Checkpoint failed, retrying after %d more records.\n", CheckpointEvery);
+    }
+
+    Pending[PendingCount].op = op;
+    Pending[PendingCount].key = x;
+    PendingCount++;
+
+    if (PendingCount == GroupSize) wal_sync();
+
+    if (CheckpointEvery > 0 && ++SinceCheckpoint >= CheckpointEvery) CheckpointDue = 1;
+}
+
+
+/**
+    @brief write the pending records to the log and wait until they are on disk
+    @param -
+    @return -
+*/
+void wal_sync() {
+    if (LogFd == -1 || PendingCount == 0) return;
+
+    if (write_all(LogFd, Pending, PendingCount * sizeof(WalRecord)) != 0 || fsync(LogFd) != 0)
+        perror(LogPath);
+
+    PendingCount = 0;
+}
+
+
+/**
+    @brief write every key of the global tree to the checkpoint file and empty the log
+    @param -
+    @return 0 on success, -1 on error (the log is kept)
+*/
+int checkpoint() {
+    if (LogFd == -1) {
+        fprintf(stderr, "Log is not open.\n");
+        return -1;
+    }
+
+    size_t length = strlen(CheckpointPath);
+    char * tmp_path = (char *)malloc(length + 5);
+    Item * keys = (Item *)malloc(WAL_BUFFER * sizeof(Item));
+
+    if (!tmp_path || !keys) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(tmp_path);
+        free(keys);
+        return -1;
+    }
+
+    // write a new file and rename it over the old one, so there is always a complete checkpoint
+    sprintf(tmp_path, "%s.tmp", CheckpointPath);
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd == -1) {
+        perror(tmp_path);
+        free(tmp_path);
+        free(keys);
+        return -1;
+    }
+
+    WalCheckpoint header;
+    header.magic = WAL_MAGIC;
+    header.version = 1;
+    header.count = 0;
+
+    struct checkpoint_writer w = { fd, keys, 0, 0 };
+
+    // the header is written first with a zero count and fixed once the keys are out
+    if (write_all(fd, &header, sizeof(header)) != 0) w.error = 1;
+
+    // insert() and delete() move T down the tree, and a due checkpoint is taken from
+    // inside them, so start from the root
+    Tree24 * root = T;
+    while (root != NULL && root->parent != NULL) root = root->parent;
+
+    if (root != NULL && root->Count > 0) {
+        write_keys(&w, root);
+        if (!w.error && w.count > 0 && write_all(fd, keys, w.count * sizeof(Item)) != 0) w.error = 1;
+    }
+
+    if (!w.error) {
+        off_t size = lseek(fd, 0, SEEK_END);
+        header.count = (size - (off_t)sizeof(header)) / (off_t)sizeof(Item);
+
+        if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) w.error = 1;
+    }
+
+    if (!w.error && fsync(fd) != 0) w.error = 1;
+    if (close(fd) != 0) w.error = 1;
+
+    if (w.error || rename(tmp_path, CheckpointPath) != 0) {
+        perror(tmp_path);
+        unlink(tmp_path);
+        free(tmp_path);
+        free(keys);
+        return -1;
+    }
+
+    free(tmp_path);
+    free(keys);
+
+    // the log may only be emptied once the rename itself is on disk
+    if (sync_directory(CheckpointPath) != 0) return -1;
+
+    // everything logged so far is in the checkpoint
+    PendingCount = 0;
+    if (ftruncate(LogFd, 0) != 0 || fsync(LogFd) != 0) perror(LogPath);
+
+    SinceCheckpoint = 0;
+    CheckpointDue = 0;
+    FailedCheckpoints = 0;
+
+    return 0;
+}
+
+
+/**
+    @brief rebuild the global tree from the latest checkpoint and the log written after it
+    @details the current global tree (if any) is destroyed
+    @param log_path the operation log (may not exist)
+    @param checkpoint_path the checkpoint (may not exist)
+    @return the number of operations replayed from the log, -1 on error
+*/
+int recover(const char * log_path, const char * checkpoint_path) {
+    Item * keys = NULL;
+    long count = 0;
+
+    int fd = open(checkpoint_path, O_RDONLY);
+
+    if (fd != -1) {
+        WalCheckpoint header;
+
+        if (read(fd, &header, sizeof(header)) != (ssize_t)sizeof(header) || header.magic != WAL_MAGIC || header.count < 0) {
+            fprintf(stderr, "%s is not a checkpoint.\n", checkpoint_path);
+            close(fd);
+            return -1;
+        }
+
+        count = header.count;
+        keys = (Item *)malloc((count + 1) * sizeof(Item));
+
+        if (keys == NULL) {
+            fprintf(stderr, "Unable to allocate memory.\n");
+            close(fd);
+            return -1;
+        }
+
+        size_t size = count * sizeof(Item);
+        char * p = (char *)keys;
+
+        while (size > 0) {
+            ssize_t got = read(fd, p, size);
+            if (got <= 0) break;
+            p += got;
+            size -= got;
+        }
+
+        close(fd);
+
+        if (size > 0) {
+            fprintf(stderr, "%s is truncated.\n", checkpoint_path);
+            free(keys);
+            return -1;
+        }
+    }
+
+    // the checkpoint is sorted, so the tree is built bottom-up in O(n)
+    Tree24 * root = build_sorted(keys, (int)count);
+    free(keys);
+
+    if (root == NULL) return -1;
+
+    if (T != NULL) destroy();
+    T = root;
+
+    fd = open(log_path, O_RDONLY);
+    if (fd == -1) return 0;
+
+    WalRecord * records = (WalRecord *)malloc(WAL_BUFFER * sizeof(WalRecord));
+
+    if (records == NULL) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        close(fd);
+        return -1;
+    }
+
+    int saved_verbose = Verbose;
+    Verbose = 0;
+    Replaying = 1;
+
+    int replayed = 0;
+    size_t left = 0;
+
+    while (1) {
+        ssize_t got = read(fd, (char *)records + left, WAL_BUFFER * sizeof(WalRecord) - left);
+        if (got <= 0) break;
+
+        size_t bytes = left + got;
+        size_t complete = bytes / sizeof(WalRecord);
+
+        for (size_t i = 0; i < complete; i++) {
+            if (records[i].op == WAL_INSERT) insert(records[i].key);
+            else if (records[i].op == WAL_DELETE) delete(records[i].key);
+            else continue;
+
+            replayed++;
+        }
+
+        // keep a record split between two reads for the next one
+        left = bytes - complete * sizeof(WalRecord);
+        memmove(records, (char *)records + complete * sizeof(WalRecord), left);
+    }
+
+    // a partial record at the end was being written during the crash and is ignored
+
+    Replaying = 0;
+    Verbose = saved_verbose;
+
+    free(records);
+    close(fd);
+
+    return replayed;
+}
+
+
+/**
+    @brief report the automatic checkpoints that failed, insert() and delete() cannot return them
+    @param -
+    @return the number of automatic checkpoints that failed since the last one that succeeded
+*/
+int wal_failures() {
+    return FailedCheckpoints;
+}
+
+
+/**
+    @brief write the pending records and stop logging
+    @param -
+    @return -
+*/
+void wal_close() {
+    if (LogFd != -1) {
+        wal_sync();
+        close(LogFd);
+    }
+
+    LogFd = -1;
+
+    free(LogPath);
+    free(CheckpointPath);
+    free(Pending);
+
+    LogPath = NULL;
+    CheckpointPath = NULL;
+    Pending = NULL;
+    PendingCount = 0;
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef WALINTERFACE_H
+#define WALINTERFACE_H
+
+#include <stdint.h>
+#include "Tree24Interface.h"
+
+// operations stored in the log
+#define WAL_INSERT 1
+#define WAL_DELETE 2
+
+// records written with a single fsync() by default
+#define WAL_DEFAULT_GROUP 64
+
+// first bytes of a checkpoint file
+#define WAL_MAGIC 0x43343254 // "T24C"
+
+// one record of the operation log
+typedef struct wal_record {
+    int32_t op;
+    int32_t key;
+} WalRecord;
+
+// header of a checkpoint file, followed by count keys in increasing order
+typedef struct wal_checkpoint {
+    uint32_t magic;
+    uint32_t version;
+    int64_t count;
+} WalCheckpoint;
+
+int wal_open(const char *, const char *, int, int);
+void wal_append(int, Key);
+void wal_sync();
+int checkpoint();
+int recover(const char *, const char *);
+int wal_failures();
+void wal_close();
+
+#endif
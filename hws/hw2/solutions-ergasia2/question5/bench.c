@@ -0,0 +1,241 @@
+/**
+    @file bench.c
+    @author Anastasia Marinakou | sdi2400120
+    @details Course: Data Structures and Programming Techniques (Even) - 2025
+    @brief multi-threaded throughput benchmark for any implementation of Tree24Interface.h
+    @details Built twice by the Makefile: bench-tree (the (2, 4) Tree, every call
+    behind one mutex) and bench-skiplist (the lock-free skip list, compiled with LOCK_FREE).
+    bench-tree also measures the operation log (WalImplementation.c): what it costs on
+    the insert path and how long recovery takes.
+
+    usage: ./bench-tree [threads] [operations per thread] [key range] [write %]
+           ./bench-tree wal [operations] [key range] [group]
+*/
+
+#ifndef BENCH_C
+#define BENCH_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include "Tree24Interface.h"
+
+#ifdef LOCK_FREE
+#define LOCK()
+#define UNLOCK()
+#else
+#include <string.h>
+#include <unistd.h>
+#include "WalInterface.h"
+
+// the (2, 4) Tree is not thread safe, so serialize every call
+pthread_mutex_t Lock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK() pthread_mutex_lock(&Lock)
+#define UNLOCK() pthread_mutex_unlock(&Lock)
+
+// files written by the operation log benchmark, removed when it ends
+#define BENCH_LOG "bench.log"
+#define BENCH_CHECKPOINT "bench.checkpoint"
+#endif
+
+int Operations = 1000000;
+int Keys = 1000000;
+int WritePercent = 50;
+
+
+/**
+    @brief helper function that returns the current time in seconds
+    @return monotonic time in seconds
+*/
+double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+
+/**
+    @brief run Operations random operations (inserts and deletes for WritePercent %, searches for the rest)
+    @param arg the thread's number, used as the random seed
+    @return NULL
+*/
+void * worker(void * arg) {
+    uint64_t seed = 0x9e3779b97f4a7c15ULL * (uint64_t)((intptr_t)arg + 1);
+
+    for (int i = 0; i < Operations; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+
+        int key = (int)((seed >> 16) % (uint64_t)Keys);
+        int op = (int)((seed >> 8) % 100);
+
+        LOCK();
+        if (op < WritePercent / 2) insert(key);
+        else if (op < WritePercent) delete(key);
+        else search(key);
+        UNLOCK();
+    }
+
+    return NULL;
+}
+
+
+#ifndef LOCK_FREE
+/**
+    @brief helper function that runs Operations random inserts (75 %) and deletes on the global tree
+    @param -
+    @return the time in seconds
+*/
+double wal_run() {
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    double start = now();
+
+    for (int i = 0; i < Operations; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+
+        int key = (int)((seed >> 16) % (uint64_t)Keys);
+
+        if ((seed >> 8) % 4 != 0) insert(key);
+        else delete(key);
+    }
+
+    return now() - start;
+}
+
+
+/**
+    @brief helper function that destroys the global tree, rebuilds it from the log and checks the result
+    @param log the operation log
+    @param checkpoint the checkpoint (may not exist)
+    @param keys the number of keys the tree had
+    @return the time recover() took in seconds, -1 if the rebuilt tree is wrong
+*/
+double wal_recover(const char * log, const char * checkpoint, int keys) {
+    destroy();
+
+    double start = now();
+    int replayed = recover(log, checkpoint);
+    double seconds = now() - start;
+
+    if (replayed < 0 || count() != keys) return -1;
+
+    printf("    recovery: %.3f s (%d records replayed)\n", seconds, replayed);
+    return seconds;
+}
+
+
+/**
+    @brief measure the cost of the operation log on the insert path and the time to recover
+    @details runs the same operations without the log, with the log, and with the log and a
+    checkpoint every Operations / 8 records, and recovers the last two runs from their files
+    @param group records per fsync() (0 for WAL_DEFAULT_GROUP)
+    @return 0 on success, 1 on error
+*/
+int wal_bench(int group) {
+    unlink(BENCH_LOG);
+    unlink(BENCH_CHECKPOINT);
+
+    init();
+    double base = wal_run();
+    int keys = count();
+    destroy();
+
+    printf("%d operations (75%% inserts), %d keys left\n", Operations, keys);
+    printf("no log: %.3f s, %.2f Mops/s\n", base, Operations / base / 1e6);
+
+    for (int run = 0; run < 2; run++) {
+        int every = (run == 0) ? 0 : (Operations >= 8 ? Operations / 8 : 1);
+
+        unlink(BENCH_LOG);
+        unlink(BENCH_CHECKPOINT);
+
+        init();
+        if (wal_open(BENCH_LOG, BENCH_CHECKPOINT, group, every) != 0) return 1;
+
+        double seconds = wal_run();
+        wal_close();
+
+        printf("log, group %d, checkpoint every %d records: %.3f s, %.2f Mops/s (%.2fx the time without it)\n",
+               group > 0 ? group : WAL_DEFAULT_GROUP, every, seconds, Operations / seconds / 1e6, seconds / base);
+
+        if (wal_recover(BENCH_LOG, BENCH_CHECKPOINT, keys) < 0) {
+            fprintf(stderr, "Recovery did not give back the tree.\n");
+            return 1;
+        }
+
+        destroy();
+    }
+
+    unlink(BENCH_LOG);
+    unlink(BENCH_CHECKPOINT);
+
+    return 0;
+}
+#endif
+
+
+int main(int argc, char ** argv) {
+#ifndef LOCK_FREE
+    if (argc > 1 && strcmp(argv[1], "wal") == 0) {
+        int group = 0;
+
+        if (argc > 2) Operations = atoi(argv[2]);
+        if (argc > 3) Keys = atoi(argv[3]);
+        if (argc > 4) group = atoi(argv[4]);
+
+        if (Operations <= 0 || Keys <= 0 || group < 0) {
+            fprintf(stderr, "usage: %s wal [operations] [key range] [group]\n", argv[0]);
+            return 1;
+        }
+
+        verbose(0);
+        return wal_bench(group);
+    }
+#endif
+
+    int threads = (argc > 1) ? atoi(argv[1]) : 1;
+    if (argc > 2) Operations = atoi(argv[2]);
+    if (argc > 3) Keys = atoi(argv[3]);
+    if (argc > 4) WritePercent = atoi(argv[4]);
+
+    if (threads <= 0 || Operations <= 0 || Keys <= 0 || WritePercent < 0 || WritePercent > 100) {
+        fprintf(stderr, "usage: %s [threads] [operations per thread] [key range] [write %%]\n", argv[0]);
+        return 1;
+    }
+
+    verbose(0);
+    init();
+
+    // start half full, so inserts and deletes both succeed about half the time
+    for (int i = 0; i < Keys; i += 2) insert(i);
+
+    pthread_t * workers = (pthread_t *)malloc(threads * sizeof(pthread_t));
+
+    if (!workers) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return 1;
+    }
+
+    double start = now();
+
+    for (int i = 0; i < threads; i++) pthread_create(&workers[i], NULL, worker, (void *)(intptr_t)i);
+    for (int i = 0; i < threads; i++) pthread_join(workers[i], NULL);
+
+    double seconds = now() - start;
+    long total = (long)threads * Operations;
+
+    printf("%d threads, %ld operations, %d%% writes: %.3f s, %.2f Mops/s, %d keys left\n",
+           threads, total, WritePercent, seconds, total / seconds / 1e6, count());
+
+    free(workers);
+    destroy();
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,624 @@
+/**
+    @file check.c
+    @author Anastasia Marinakou | sdi2400120
+    @details Course: Data Structures and Programming Techniques (Even) - 2025
+    @brief brute force check of any implementation of Tree24Interface.h
+    @details Built twice by the Makefile (make check): check-tree (the (2, 4) Tree)
+    and check-skiplist (the lock-free skip list, compiled with LOCK_FREE). Random
+    inserts and deletes are applied to the structure and to an array of flags, and
+    search(), count(), range() and find() are compared against the array. check-tree
+    also runs the tree with the hash index (comparing locate() too) and with the Bloom
+    filter, checks the shape of the tree, the trees of build_sorted(), parallel_build()
+    and merge(), and recovery from the operation log.
+    check-skiplist also runs inserts and deletes from many threads at once and then
+    checks the span counts with find().
+
+    usage: ./check-tree [seed]
+           ./check-skiplist [seed]
+*/
+
+#ifndef CHECK_C
+#define CHECK_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "Tree24Interface.h"
+
+#ifndef LOCK_FREE
+#include <unistd.h>
+#include "BloomInterface.h"
+#include "WalInterface.h"
+
+extern Tree24 * T;
+extern BloomFilter * Filter;
+
+// files written by the operation log check, removed when it ends
+#define CHECK_LOG "check.log"
+#define CHECK_CHECKPOINT "check.checkpoint"
+
+// a checkpoint that can never be written, its directory does not exist
+#define CHECK_NO_CHECKPOINT "check-missing/check.checkpoint"
+#endif
+
+// keys are taken from 0 .. CHECK_KEYS - 1
+#define CHECK_KEYS 3000
+
+// random operations per round, compared against the flags every CHECK_EVERY of them
+#define CHECK_OPERATIONS 40000
+#define CHECK_EVERY 4000
+
+// threads of the concurrent check
+#define CHECK_THREADS 4
+
+// Live[k] is 1 when the structure should hold k
+char Live[CHECK_KEYS];
+
+// keys reported by range()
+Item Got[CHECK_KEYS + 1];
+int GotCount = 0;
+
+int Checks = 0;
+int Failed = 0;
+
+
+/**
+    @brief helper function that counts one check and reports it if it failed
+    @param ok whether the check passed
+    @param what what was checked
+    @param round the round it belongs to
+    @return -
+*/
+void expect(int ok, const char * what, int round) {
+    Checks++;
+    if (ok) return;
+
+    Failed++;
+    if (Failed <= 20) printf("FAILED: %s (round %d)\n", what, round);
+}
+
+
+/**
+    @brief helper function that keeps the keys reported by range() in Got
+    @param x the key
+    @return -
+*/
+void collect(Item x) {
+    if (GotCount <= CHECK_KEYS) Got[GotCount++] = x;
+}
+
+
+#ifndef LOCK_FREE
+/**
+    @brief helper function that checks the shape of a subtree of the (2, 4) Tree
+    @details the keys of every node are increasing and between low and high, every
+    leaf is at the same depth and the parent pointers are right
+    @param node the subtree
+    @param parent its parent (NULL for the root)
+    @param depth its depth
+    @param low every key is greater than this
+    @param high every key is less than this
+    @param leaf_depth the depth of the leaves, -1 until the first leaf is found
+    @return the number of keys in the subtree, -1 if the subtree is wrong
+*/
+int validate(Tree24 * node, Tree24 * parent, int depth, long low, long high, int * leaf_depth) {
+    if (node->parent != parent) return -1;
+    if (node->Count > 3 || (node->Count < 1 && parent != NULL)) return -1;
+
+    for (int i = 0; i < node->Count; i++) {
+        if (node->items[i] <= low || node->items[i] >= high) return -1;
+        if (i > 0 && node->items[i] <= node->items[i - 1]) return -1;
+    }
+
+    int leaf = (node->children[0] == NULL);
+
+    for (int i = 0; i <= node->Count; i++) {
+        if ((node->children[i] == NULL) != leaf) return -1;
+    }
+
+    if (leaf) {
+        if (*leaf_depth == -1) *leaf_depth = depth;
+        return (*leaf_depth == depth) ? node->Count : -1;
+    }
+
+    int keys = node->Count;
+
+    for (int i = 0; i <= node->Count; i++) {
+        long child_low = (i > 0) ? node->items[i - 1] : low;
+        long child_high = (i < node->Count) ? node->items[i] : high;
+
+        int size = validate(node->children[i], node, depth + 1, child_low, child_high, leaf_depth);
+        if (size < 0) return -1;
+
+        keys += size;
+    }
+
+    return keys;
+}
+
+
+/**
+    @brief helper function that tells whether a node holds a key
+    @param node the node (may be NULL)
+    @param x the key
+    @return 1 if it does, 0 otherwise
+*/
+int holds(Tree24 * node, Key x) {
+    if (node == NULL) return 0;
+
+    for (int i = 0; i < node->Count; i++) {
+        if (node->items[i] == x) return 1;
+    }
+
+    return 0;
+}
+#endif
+
+
+/**
+    @brief compare the structure against Live with every query of the interface
+    @param round the round, for the report
+    @return -
+*/
+void check_contents(int round) {
+    int n = 0;
+
+    for (int k = 0; k < CHECK_KEYS; k++) n += Live[k];
+
+    // an empty structure answers every query with ERROR
+    if (n == 0) {
+        expect(count() == ERROR && search(0) == ERROR, "count() and search() when empty", round);
+#ifndef LOCK_FREE
+        expect(T != NULL && T->Count == 0, "empty root", round);
+#endif
+        return;
+    }
+
+    int found = 1;
+
+    for (int k = 0; k < CHECK_KEYS; k++) {
+        if ((search(k) != ERROR) != Live[k]) found = 0;
+    }
+
+    expect(found, "search() of every key", round);
+
+#ifndef LOCK_FREE
+    int located = 1;
+
+    for (int k = 0; k < CHECK_KEYS; k++) {
+        if ((Live[k] ? !holds(locate(k), k) : locate(k) != NULL)) located = 0;
+    }
+
+    expect(located, "locate() of every key", round);
+#endif
+    expect(count() == n, "count()", round);
+
+    // every key, in order
+    GotCount = 0;
+    int reported = range(-1, CHECK_KEYS, collect);
+    int ordered = (reported == n && GotCount == n);
+
+    for (int k = 0, j = 0; ordered && k < CHECK_KEYS; k++) {
+        if (Live[k] && Got[j++] != k) ordered = 0;
+    }
+
+    expect(ordered, "range() over every key", round);
+
+    if (ordered) {
+        int ranks = 1;
+
+        for (int r = 1; r <= n; r++) {
+            if (find(r) != Got[r - 1]) ranks = 0;
+        }
+
+        expect(ranks, "find() of every rank", round);
+    }
+
+    for (int i = 0; i < 5; i++) {
+        int low = rand() % CHECK_KEYS;
+        int high = low + rand() % 200;
+        int want = 0;
+
+        for (int k = low; k <= high && k < CHECK_KEYS; k++) want += Live[k];
+
+        GotCount = 0;
+        reported = range(low, high, collect);
+
+        int inside = (reported == want && GotCount == want);
+        for (int j = 0; inside && j < GotCount; j++) {
+            if (Got[j] < low || Got[j] > high || !Live[Got[j]] || (j > 0 && Got[j] <= Got[j - 1])) inside = 0;
+        }
+
+        expect(inside, "range() of part of the keys", round);
+    }
+
+#ifndef LOCK_FREE
+    Tree24 * root = T;
+    while (root != NULL && root->parent != NULL) root = root->parent;
+
+    int leaf_depth = -1;
+    expect(root != NULL && validate(root, NULL, 0, -1, CHECK_KEYS, &leaf_depth) == n, "shape of the tree", round);
+#endif
+}
+
+
+/**
+    @brief apply random inserts and deletes to the global structure and to Live
+    @param operations the number of operations
+    @param round the round, for the report
+    @return -
+*/
+void random_operations(int operations, int round) {
+    for (int i = 0; i < operations; i++) {
+        int k = rand() % CHECK_KEYS;
+
+        if (rand() % 3 != 0) {
+            insert(k);
+            Live[k] = 1;
+        }
+        else {
+            delete(k);
+            Live[k] = 0;
+        }
+
+        if (i % CHECK_EVERY == CHECK_EVERY - 1) check_contents(round);
+    }
+}
+
+
+/**
+    @brief random operations on an empty structure, then delete every key
+    @details the (2, 4) Tree is run plain, with the hash index and with the Bloom filter
+    @param round the round
+    @return -
+*/
+void check_operations(int round) {
+    init();
+    memset(Live, 0, sizeof(Live));
+
+#ifndef LOCK_FREE
+    if (round % 3 == 1) enable_index();
+    if (round % 3 == 2) enable_filter(10);
+#endif
+
+    check_contents(round);
+    random_operations(CHECK_OPERATIONS, round);
+
+#ifndef LOCK_FREE
+    // the filter was rebuilt while the tree grew, and every block must still be one cache line
+    if (round % 3 == 2) {
+        expect(Filter != NULL && (uintptr_t)Filter->blocks % (BLOOM_BLOCK_BITS / 8) == 0, "Bloom filter blocks on cache lines", round);
+    }
+#endif
+
+    for (int k = 0; k < CHECK_KEYS; k++) {
+        delete(k);
+        Live[k] = 0;
+    }
+
+    check_contents(round);
+    destroy();
+}
+
+
+#ifndef LOCK_FREE
+/**
+    @brief helper function that fills keys with random keys (duplicates allowed) and marks them in Live
+    @param keys where the keys go
+    @param n the number of keys
+    @return -
+*/
+void random_keys(Item * keys, int n) {
+    for (int i = 0; i < n; i++) {
+        keys[i] = rand() % CHECK_KEYS;
+        Live[keys[i]] = 1;
+    }
+}
+
+
+/**
+    @brief helper function that orders keys, for qsort()
+    @param a the first key
+    @param b the second key
+    @return the order of a and b
+*/
+int compare_keys(const void * a, const void * b) {
+    Item x = *(const Item *)a;
+    Item y = *(const Item *)b;
+
+    return (x > y) - (x < y);
+}
+
+
+/**
+    @brief helper function that sorts keys and removes the duplicates, the input build_sorted() needs
+    @param keys the keys, not changed
+    @param n the number of keys
+    @param sorted where the distinct keys go, in increasing order
+    @return the number of distinct keys
+*/
+int sorted_keys(Item * keys, int n, Item * sorted) {
+    memcpy(sorted, keys, n * sizeof(Item));
+    qsort(sorted, n, sizeof(Item), compare_keys);
+
+    int distinct = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (distinct == 0 || sorted[distinct - 1] != sorted[i]) sorted[distinct++] = sorted[i];
+    }
+
+    return distinct;
+}
+
+
+/**
+    @brief helper function that checks whether two trees have the same shape and keys
+    @param a the first tree
+    @param b the second tree
+    @return 1 if they are the same, 0 otherwise
+*/
+int same_tree(Tree24 * a, Tree24 * b) {
+    if (a == NULL || b == NULL) return a == b;
+    if (a->Count != b->Count) return 0;
+
+    for (int i = 0; i < a->Count; i++) {
+        if (a->items[i] != b->items[i]) return 0;
+    }
+
+    for (int i = 0; i <= a->Count; i++) {
+        if (a->children[i] != NULL && a->N[i] != b->N[i]) return 0;
+        if (!same_tree(a->children[i], b->children[i])) return 0;
+    }
+
+    return 1;
+}
+
+
+/**
+    @brief helper function that frees a tree that is not the global one
+    @param node the root of the tree
+    @return -
+*/
+void free_tree(Tree24 * node) {
+    if (node == NULL) return;
+
+    for (int i = 0; i <= node->Count; i++) free_tree(node->children[i]);
+    free(node);
+}
+
+
+/**
+    @brief compare build_sorted(), parallel_build() and merge() against Live
+    @param n the number of random keys
+    @param round the round
+    @return -
+*/
+void check_bulk(int n, int round) {
+    Item * keys = (Item *)malloc((n + 2) * sizeof(Item));
+    Item * sorted = (Item *)malloc((n + 2) * sizeof(Item));
+
+    if (!keys || !sorted) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        exit(1);
+    }
+
+    // build_sorted() becomes the global tree
+    memset(Live, 0, sizeof(Live));
+    random_keys(keys, n);
+
+    T = build_sorted(sorted, sorted_keys(keys, n, sorted));
+    check_contents(round);
+
+    // the parallel builds must give the same tree, whatever the number of threads
+    int threads[] = { 1, 2, 5 };
+
+    for (int i = 0; i < 3; i++) {
+        Tree24 * built = parallel_build(keys, n, threads[i]);
+        expect(same_tree(built, T), "parallel_build() gives the tree of build_sorted()", round);
+        free_tree(built);
+    }
+
+    // merge another tree into the global tree, the global tree becomes the result
+    int more = n / 2 + 1;
+    random_keys(keys, more);
+
+    T = merge(T, parallel_build(keys, more, 2));
+    check_contents(round);
+    destroy();
+
+    // merge two trees that are not the global one
+    memset(Live, 0, sizeof(Live));
+    random_keys(keys, n);
+    Tree24 * first = parallel_build(keys, n, 3);
+
+    random_keys(keys, more);
+    Tree24 * second = parallel_build(keys, more, 1);
+
+    T = merge(first, second);
+    check_contents(round);
+
+    // the merged tree still takes inserts and deletes
+    random_operations(CHECK_EVERY, round);
+    destroy();
+
+    free(keys);
+    free(sorted);
+}
+
+
+/**
+    @brief log random operations, then rebuild the tree with recover() and compare it against Live
+    @param group records written with one fsync()
+    @param every take a checkpoint every this many records (0 for one checkpoint on request)
+    @param round the round
+    @return -
+*/
+void check_log(int group, int every, int round) {
+    unlink(CHECK_LOG);
+    unlink(CHECK_CHECKPOINT);
+
+    init();
+    memset(Live, 0, sizeof(Live));
+
+    if (wal_open(CHECK_LOG, CHECK_CHECKPOINT, group, every) != 0) {
+        expect(0, "wal_open()", round);
+        destroy();
+        return;
+    }
+
+    random_operations(CHECK_OPERATIONS / 4, round);
+    if (every == 0) expect(checkpoint() == 0, "checkpoint()", round);
+    random_operations(CHECK_EVERY, round);
+
+    wal_close();
+    destroy();
+
+    expect(recover(CHECK_LOG, CHECK_CHECKPOINT) >= 0, "recover()", round);
+    check_contents(round);
+    destroy();
+
+    // a record cut in half by a crash is ignored
+    FILE * log = fopen(CHECK_LOG, "ab");
+
+    if (log != NULL) {
+        fwrite("\1\0\0", 1, 3, log);
+        fclose(log);
+    }
+
+    expect(recover(CHECK_LOG, CHECK_CHECKPOINT) >= 0, "recover() with a torn record", round);
+    check_contents(round);
+    destroy();
+
+    unlink(CHECK_LOG);
+    unlink(CHECK_CHECKPOINT);
+}
+
+
+/**
+    @brief log random operations with automatic checkpoints that always fail
+    @details a failed checkpoint must only be tried again after another CheckpointEvery records,
+    and the log alone must still rebuild the tree
+    @param round the round
+    @return -
+*/
+void check_failing_log(int round) {
+    int every = 1000;
+    int operations = CHECK_OPERATIONS / 4;
+
+    unlink(CHECK_LOG);
+
+    init();
+    memset(Live, 0, sizeof(Live));
+
+    if (wal_open(CHECK_LOG, CHECK_NO_CHECKPOINT, 0, every) != 0) {
+        expect(0, "wal_open()", round);
+        destroy();
+        return;
+    }
+
+    random_operations(operations, round);
+
+    int failures = wal_failures();
+    expect(failures > 0 && failures <= operations / every, "failed checkpoints are retried after checkpoint_every records", round);
+
+    wal_close();
+    destroy();
+
+    expect(recover(CHECK_LOG, CHECK_NO_CHECKPOINT) >= 0, "recover() without a checkpoint", round);
+    check_contents(round);
+    destroy();
+
+    unlink(CHECK_LOG);
+}
+#endif
+
+
+#ifdef LOCK_FREE
+/**
+    @brief random inserts and deletes from one of CHECK_THREADS threads, on the keys k with k % CHECK_THREADS == id
+    @details every thread owns its keys, so search() must see its own updates at once
+    @param arg the thread's number
+    @return the number of searches that did not see the thread's last update
+*/
+void * check_worker(void * arg) {
+    int id = (int)(intptr_t)arg;
+    uint64_t seed = 0x9e3779b97f4a7c15ULL * (uint64_t)(id + 1);
+    intptr_t wrong = 0;
+
+    for (int i = 0; i < CHECK_OPERATIONS / 4; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+
+        int k = id + CHECK_THREADS * (int)((seed >> 16) % (uint64_t)(CHECK_KEYS / CHECK_THREADS));
+
+        if ((seed >> 8) % 3 != 0) {
+            insert(k);
+            Live[k] = 1;
+        }
+        else {
+            delete(k);
+            Live[k] = 0;
+        }
+
+        if ((search(k) != ERROR) != Live[k]) wrong++;
+    }
+
+    return (void *)wrong;
+}
+
+
+/**
+    @brief run check_worker() on CHECK_THREADS threads at once and compare the result against Live
+    @param round the round
+    @return -
+*/
+void check_threads(int round) {
+    init();
+    memset(Live, 0, sizeof(Live));
+
+    pthread_t workers[CHECK_THREADS];
+
+    for (int i = 0; i < CHECK_THREADS; i++) pthread_create(&workers[i], NULL, check_worker, (void *)(intptr_t)i);
+
+    for (int i = 0; i < CHECK_THREADS; i++) {
+        void * wrong;
+        pthread_join(workers[i], &wrong);
+        expect(wrong == NULL, "search() after an update from many threads", round);
+    }
+
+    check_contents(round);
+    destroy();
+}
+#endif
+
+
+int main(int argc, char ** argv) {
+    srand((argc > 1) ? (unsigned)atoi(argv[1]) : 1);
+    verbose(0);
+
+    int round = 0;
+
+    for (; round < 6; round++) check_operations(round);
+
+#ifndef LOCK_FREE
+    int sizes[] = { 0, 1, 2, 3, 7, 100, 1000, 5000 };
+
+    for (int i = 0; i < 8; i++) check_bulk(sizes[i], round++);
+
+    check_log(1, 0, round++);
+    check_log(0, 0, round++);
+    check_log(8, 500, round++);
+    check_failing_log(round++);
+#else
+    for (int i = 0; i < 3; i++) check_threads(round++);
+#endif
+
+    printf("%s: %d checks, %d failed\n", argv[0], Checks, Failed);
+
+    return Failed > 0;
+}
+
+#endif
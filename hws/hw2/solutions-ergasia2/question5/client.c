@@ -0,0 +1,440 @@
+/**
+    @file client.c
+    @author Anastasia Marinakou | sdi2400120
+    @details Course: Data Structures and Programming Techniques (Even) - 2025
+    @brief load generator for server.c: throughput and latency percentiles
+    @details Every connection runs in its own thread and keeps [depth] requests in flight:
+    it sends requests until [depth] are unanswered, reads whatever responses have arrived
+    and sends as many new requests together. The sockets are non-blocking and every
+    connection waits with poll() for room to send and for responses at the same time, so
+    it keeps reading while the server is busy answering requests it has not sent yet.
+    The latency of a request is the time from when its batch started being sent to the
+    read() that received its response.
+
+    usage: ./client [socket path] [connections] [requests per connection] [depth] [key range] [write %] [range %]
+*/
+
+#ifndef CLIENT_C
+#define CLIENT_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "ProtocolInterface.h"
+
+// keys returned by one range scan
+#define CLIENT_RANGE_WIDTH 100
+
+const char * Path = PROTOCOL_SOCKET;
+int Requests = 1000000;
+int Depth = 64;
+int Keys = 1000000;
+int WritePercent = 50;
+int RangePercent = 0;
+
+// latencies of every request of every connection, in nanoseconds
+int64_t * Latencies;
+
+
+/**
+    @brief helper function that returns the current time in nanoseconds
+    @return monotonic time in nanoseconds
+*/
+int64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+
+/**
+    @brief helper function that connects to the server
+    @return the socket (non-blocking), -1 on error
+*/
+int connect_server() {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, Path, sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd == -1 || connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+        perror(Path);
+        if (fd != -1) close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+/**
+    @brief helper function that sends as much of a buffer as the socket takes without blocking
+    @param fd the socket
+    @param buffer the data
+    @param size the number of bytes
+    @return the number of bytes sent (0 if the socket is full), -1 on error
+*/
+ssize_t send_some(int fd, const void * buffer, size_t size) {
+    ssize_t sent = send(fd, buffer, size, MSG_NOSIGNAL);
+
+    if (sent < 0) return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+
+    return sent;
+}
+
+
+/**
+    @brief helper function that reads what has arrived on a socket without blocking
+    @param fd the socket
+    @param buffer where to put it
+    @param size the room in buffer
+    @return the number of bytes read (0 if nothing has arrived), -1 on error or if the server closed
+*/
+ssize_t receive_some(int fd, void * buffer, size_t size) {
+    ssize_t got = read(fd, buffer, size);
+
+    if (got == 0) return -1;
+    if (got < 0) return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+
+    return got;
+}
+
+
+/**
+    @brief helper function that waits until a socket can be read or, if asked, written
+    @param fd the socket
+    @param writing also wait for room to send
+    @return the events that happened (POLLIN, POLLOUT, ...), 0 if interrupted, -1 on error
+*/
+int wait_socket(int fd, int writing) {
+    struct pollfd p;
+    p.fd = fd;
+    p.events = POLLIN | (writing ? POLLOUT : 0);
+    p.revents = 0;
+
+    if (poll(&p, 1, -1) < 0) return (errno == EINTR) ? 0 : -1;
+
+    return p.revents;
+}
+
+
+// state of one connection
+struct load {
+    int id;
+    int fd;
+
+    // what is left to parse of the responses received
+    char * in;
+    int in_len;
+    int in_size;
+
+    // the send time of every request, the response of request i is expected after the one of i - 1
+    int64_t * sent_at;
+    int received;
+    int failed;
+};
+
+
+/**
+    @brief helper function that parses the responses received so far
+    @param l the connection
+    @param arrived when they were received
+    @return -
+*/
+void parse_responses(struct load * l, int64_t arrived) {
+    int done = 0;
+
+    while (l->in_len - done >= (int)sizeof(Response)) {
+        Response r;
+        memcpy(&r, l->in + done, sizeof(r));
+
+        // a range scan is followed by its keys; wait until they have all arrived
+        int size = sizeof(Response);
+        if (r.status == STATUS_OK && r.value > 0 && l->sent_at[l->received] < 0) size += r.value * sizeof(int32_t);
+
+        if (l->in_len - done < size) break;
+
+        done += size;
+
+        int64_t sent = l->sent_at[l->received];
+        if (sent < 0) sent = -sent;
+
+        Latencies[(int64_t)l->id * Requests + l->received] = arrived - sent;
+        l->received++;
+    }
+
+    memmove(l->in, l->in + done, l->in_len - done);
+    l->in_len -= done;
+}
+
+
+/**
+    @brief run Requests requests on one connection with Depth of them in flight
+    @param arg the connection's struct load
+    @return NULL
+*/
+void * run_load(void * arg) {
+    struct load * l = (struct load *)arg;
+    uint64_t seed = 0x9e3779b97f4a7c15ULL * (uint64_t)(l->id + 1);
+    Request * batch = (Request *)malloc(Depth * sizeof(Request));
+
+    if (batch == NULL) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        l->failed = 1;
+        return NULL;
+    }
+
+    int issued = 0;
+
+    // the batch being sent: bytes [out_sent, out_len) of batch are left
+    size_t out_len = 0;
+    size_t out_sent = 0;
+
+    while (l->received < Requests) {
+        // once the batch is out, fill the pipeline up to Depth requests
+        int count = 0;
+
+        while (out_sent == out_len && issued + count < Requests && issued + count - l->received < Depth) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+
+            Request * q = &batch[count++];
+            memset(q, 0, sizeof(*q));
+
+            int op = (int)((seed >> 8) % 100);
+            q->key = (int32_t)((seed >> 16) % (uint64_t)Keys);
+
+            if (op < WritePercent / 2) q->op = OP_INSERT;
+            else if (op < WritePercent) q->op = OP_DELETE;
+            else if (op < WritePercent + RangePercent) {
+                q->op = OP_RANGE;
+                q->key2 = q->key + CLIENT_RANGE_WIDTH - 1;
+            } else q->op = OP_SEARCH;
+        }
+
+        if (count > 0) {
+            int64_t t = now_ns();
+
+            // range scans are remembered with a negative time, their responses are longer
+            for (int i = 0; i < count; i++) l->sent_at[issued + i] = (batch[i].op == OP_RANGE) ? -t : t;
+
+            out_len = count * sizeof(Request);
+            out_sent = 0;
+            issued += count;
+        }
+
+        if (l->in_size - l->in_len < 65536) {
+            l->in_size = l->in_size ? 2 * l->in_size : 1 << 20;
+            char * in = (char *)realloc(l->in, l->in_size);
+
+            if (in == NULL) {
+                fprintf(stderr, "Unable to allocate memory.\n");
+                l->failed = 1;
+                break;
+            }
+
+            l->in = in;
+        }
+
+        int events = wait_socket(l->fd, out_sent < out_len);
+
+        if (events < 0) {
+            l->failed = 1;
+            break;
+        }
+
+        if (events & POLLOUT) {
+            ssize_t sent = send_some(l->fd, (char *)batch + out_sent, out_len - out_sent);
+
+            if (sent < 0) {
+                l->failed = 1;
+                break;
+            }
+
+            out_sent += sent;
+        }
+
+        if (events & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t got = receive_some(l->fd, l->in + l->in_len, l->in_size - l->in_len);
+
+            if (got < 0) {
+                l->failed = 1;
+                break;
+            }
+
+            l->in_len += got;
+            if (got > 0) parse_responses(l, now_ns());
+        }
+    }
+
+    free(batch);
+
+    return NULL;
+}
+
+
+/**
+    @brief helper function for qsort() on latencies
+    @return the order of a and b
+*/
+int compare_latency(const void * a, const void * b) {
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+
+/**
+    @brief helper function that fills the first tree to half its key range, so that
+    inserts, deletes and searches each succeed about half the time
+    @return 0 on success, -1 on error
+*/
+int preload() {
+    int fd = connect_server();
+    if (fd == -1) return -1;
+
+    int batch = 4096;
+    Request * q = (Request *)calloc(batch, sizeof(Request));
+    Response * r = (Response *)malloc(batch * sizeof(Response));
+
+    if (!q || !r) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(q);
+        free(r);
+        close(fd);
+        return -1;
+    }
+
+    int error = 0;
+
+    for (int start = 0; start < Keys && !error; start += 2 * batch) {
+        int count = 0;
+
+        for (int key = start; key < Keys && count < batch; key += 2) {
+            q[count].op = OP_INSERT;
+            q[count].key = key;
+            count++;
+        }
+
+        // send the batch and read its responses at the same time, all of them before the next batch
+        size_t size = count * sizeof(Request), sent = 0;
+        size_t expected = count * sizeof(Response), got = 0;
+
+        while (!error && got < expected) {
+            int events = wait_socket(fd, sent < size);
+            ssize_t n = 0;
+
+            if (events < 0) error = 1;
+
+            if (!error && (events & POLLOUT)) {
+                n = send_some(fd, (char *)q + sent, size - sent);
+                if (n < 0) error = 1;
+                else sent += n;
+            }
+
+            if (!error && (events & (POLLIN | POLLHUP | POLLERR))) {
+                n = receive_some(fd, (char *)r + got, expected - got);
+                if (n < 0) error = 1;
+                else got += n;
+            }
+        }
+    }
+
+    free(q);
+    free(r);
+    close(fd);
+
+    return error ? -1 : 0;
+}
+
+
+int main(int argc, char ** argv) {
+    int connections = 1;
+
+    if (argc > 1) Path = argv[1];
+    if (argc > 2) connections = atoi(argv[2]);
+    if (argc > 3) Requests = atoi(argv[3]);
+    if (argc > 4) Depth = atoi(argv[4]);
+    if (argc > 5) Keys = atoi(argv[5]);
+    if (argc > 6) WritePercent = atoi(argv[6]);
+    if (argc > 7) RangePercent = atoi(argv[7]);
+
+    if (connections <= 0 || Requests <= 0 || Depth <= 0 || Keys <= 0 || WritePercent < 0 || RangePercent < 0 ||
+        WritePercent + RangePercent > 100) {
+        fprintf(stderr, "usage: %s [socket path] [connections] [requests per connection] [depth] [key range] [write %%] [range %%]\n", argv[0]);
+        return 1;
+    }
+
+    if (preload() != 0) return 1;
+
+    struct load * loads = (struct load *)calloc(connections, sizeof(struct load));
+    pthread_t * threads = (pthread_t *)malloc(connections * sizeof(pthread_t));
+    Latencies = (int64_t *)malloc((int64_t)connections * Requests * sizeof(int64_t));
+
+    if (!loads || !threads || !Latencies) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return 1;
+    }
+
+    for (int i = 0; i < connections; i++) {
+        loads[i].id = i;
+        loads[i].fd = connect_server();
+        loads[i].sent_at = (int64_t *)malloc(Requests * sizeof(int64_t));
+
+        if (loads[i].fd == -1 || loads[i].sent_at == NULL) return 1;
+    }
+
+    int64_t start = now_ns();
+
+    for (int i = 0; i < connections; i++) pthread_create(&threads[i], NULL, run_load, &loads[i]);
+    for (int i = 0; i < connections; i++) pthread_join(threads[i], NULL);
+
+    double seconds = (now_ns() - start) * 1e-9;
+
+    // the latencies of the requests that were answered
+    int64_t answered = 0;
+
+    for (int i = 0; i < connections; i++) {
+        if (loads[i].failed) fprintf(stderr, "Connection %d failed after %d responses.\n", i, loads[i].received);
+
+        memmove(Latencies + answered, Latencies + (int64_t)i * Requests, loads[i].received * sizeof(int64_t));
+        answered += loads[i].received;
+    }
+
+    if (answered > 0) {
+        qsort(Latencies, answered, sizeof(int64_t), compare_latency);
+
+        printf("%d connections, depth %d, %lld requests, %d%% writes, %d%% ranges: %.3f s, %.2f Mops/s\n",
+               connections, Depth, (long long)answered, WritePercent, RangePercent, seconds, answered / seconds / 1e6);
+        printf("latency (us): p50 %.1f, p99 %.1f, p99.9 %.1f, max %.1f\n",
+               Latencies[answered / 2] / 1e3, Latencies[answered * 99 / 100] / 1e3,
+               Latencies[answered * 999 / 1000] / 1e3, Latencies[answered - 1] / 1e3);
+    }
+
+    for (int i = 0; i < connections; i++) {
+        close(loads[i].fd);
+        free(loads[i].sent_at);
+        free(loads[i].in);
+    }
+
+    free(loads);
+    free(threads);
+    free(Latencies);
+
+    return 0;
+}
+
+#endif
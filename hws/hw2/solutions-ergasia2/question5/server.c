@@ -0,0 +1,449 @@
+/**
+    @file server.c
+    @author Anastasia Marinakou | sdi2400120
+    @details Course: Data Structures and Programming Techniques (Even) - 2025
+    @brief key server: owns up to PROTOCOL_TREES (2, 4) Trees and serves them over a Unix domain socket
+    @details Single-threaded epoll event loop. Every connection may pipeline any number of
+    requests (see ProtocolInterface.h): all the complete requests read by one read() are
+    answered together, and their responses are sent with one write(). A connection whose
+    responses cannot be sent stops being read until they are (back-pressure).
+
+    usage: ./server [socket path]
+*/
+
+#ifndef SERVER_C
+#define SERVER_C
+
+// accept4()
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include "Tree24Interface.h"
+#include "ProtocolInterface.h"
+
+// the global tree of Tree24Implementation.c, pointed at the tree of each request
+extern Tree24 * T;
+
+// bytes read from a connection at once
+#define SERVER_READ 65536
+
+// events handled per epoll_wait()
+#define SERVER_EVENTS 64
+
+// a client connection
+typedef struct connection {
+    int fd;
+
+    // received bytes that do not form a whole request yet are kept for the next read
+    char in[SERVER_READ];
+    int in_len;
+
+    // responses not sent yet: out[out_sent .. out_len)
+    char * out;
+    int out_len;
+    int out_sent;
+    int out_size;
+} Connection;
+
+// the trees (NULL until first used) and how many keys each one has
+Tree24 * Trees[PROTOCOL_TREES];
+int Sizes[PROTOCOL_TREES];
+
+// the connection whose range scan is being answered (see range_visit())
+Connection * Current = NULL;
+
+// set when a key of the range scan could not be added to the output
+int RangeFailed = 0;
+
+volatile sig_atomic_t Stop = 0;
+
+
+/**
+    @brief helper function that stops the event loop on SIGINT and SIGTERM
+    @param signal the signal
+    @return -
+*/
+void stop(int signal) {
+    (void)signal;
+    Stop = 1;
+}
+
+
+/**
+    @brief helper function that makes room for size more bytes in the output of a connection
+    @param c the connection
+    @param size the number of bytes
+    @return 0 on success, -1 if allocation failed
+*/
+int reserve(Connection * c, int size) {
+    if (c->out_len + size <= c->out_size) return 0;
+
+    // drop what has already been sent before growing
+    if (c->out_sent > 0) {
+        memmove(c->out, c->out + c->out_sent, c->out_len - c->out_sent);
+        c->out_len -= c->out_sent;
+        c->out_sent = 0;
+        if (c->out_len + size <= c->out_size) return 0;
+    }
+
+    int new_size = c->out_size ? c->out_size : 4096;
+    while (new_size < c->out_len + size) new_size *= 2;
+
+    char * out = (char *)realloc(c->out, new_size);
+
+    if (out == NULL) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return -1;
+    }
+
+    c->out = out;
+    c->out_size = new_size;
+
+    return 0;
+}
+
+
+/**
+    @brief helper function that appends a response to the output of a connection
+    @param c the connection
+    @param status the status of the response
+    @param value the value of the response
+    @return 0 on success, -1 if allocation failed
+*/
+int respond(Connection * c, int status, int value) {
+    if (reserve(c, sizeof(Response)) != 0) return -1;
+
+    Response r;
+    memset(&r, 0, sizeof(r));
+    r.status = (uint8_t)status;
+    r.value = value;
+
+    memcpy(c->out + c->out_len, &r, sizeof(r));
+    c->out_len += sizeof(r);
+
+    return 0;
+}
+
+
+/**
+    @brief helper function passed on to range(), appends a key to the output of Current
+    @details range() cannot be stopped, so once a key cannot be added the rest are skipped
+    and RangeFailed is set
+    @param x the key
+    @return -
+*/
+void range_visit(Item x) {
+    if (RangeFailed) return;
+
+    if (reserve(Current, sizeof(int32_t)) != 0) {
+        RangeFailed = 1;
+        return;
+    }
+
+    int32_t key = x;
+    memcpy(Current->out + Current->out_len, &key, sizeof(key));
+    Current->out_len += sizeof(key);
+}
+
+
+/**
+    @brief helper function that answers one request
+    @param c the connection
+    @param q the request
+    @return 0 on success, -1 if allocation failed
+*/
+int serve(Connection * c, Request * q) {
+    if (q->tree >= PROTOCOL_TREES || q->op < OP_INSERT || q->op > OP_RANGE) return respond(c, STATUS_BAD, 0);
+
+    // trees are created when they are first used
+    if (Trees[q->tree] == NULL) {
+        init();
+        Trees[q->tree] = T;
+        Sizes[q->tree] = 0;
+    }
+
+    T = Trees[q->tree];
+    int * size = &Sizes[q->tree];
+
+    // search() complains about empty trees, so those are answered here
+    int present = 0;
+    if (q->op <= OP_SEARCH && *size > 0) present = (search(q->key) == q->key);
+
+    int status = STATUS_OK;
+    int value = q->key;
+
+    switch (q->op) {
+        case OP_INSERT:
+            if (present) status = STATUS_MISSING;
+            else {
+                insert(q->key);
+                (*size)++;
+            }
+            break;
+        case OP_DELETE:
+            if (!present) status = STATUS_MISSING;
+            else {
+                delete(q->key);
+                (*size)--;
+            }
+            break;
+        case OP_SEARCH:
+            if (!present) status = STATUS_MISSING;
+            break;
+        case OP_FIND:
+            if (q->key < 1 || q->key > *size) status = STATUS_MISSING;
+            else value = find(q->key);
+            break;
+        case OP_COUNT:
+            value = *size;
+            break;
+        case OP_RANGE: {
+            // the number of keys is only known after the scan, so it is written afterwards
+            if (respond(c, STATUS_OK, 0) != 0) return -1;
+
+            // reserve() may move the unsent output to the start of the buffer, so count from out_sent
+            int header = c->out_len - c->out_sent - sizeof(Response);
+
+            Current = c;
+            RangeFailed = 0;
+            int32_t visited = (*size > 0) ? range(q->key, q->key2, range_visit) : 0;
+            Current = NULL;
+
+            char * response = c->out + c->out_sent + header;
+
+            // a scan cut short is answered with STATUS_FAILED and none of its keys
+            if (RangeFailed) {
+                c->out_len = c->out_sent + header + sizeof(Response);
+                response[offsetof(Response, status)] = STATUS_FAILED;
+                visited = 0;
+            }
+
+            memcpy(response + offsetof(Response, value), &visited, sizeof(visited));
+            return 0;
+        }
+    }
+
+    // insert() and delete() may move the root
+    Trees[q->tree] = T;
+
+    return respond(c, status, value);
+}
+
+
+/**
+    @brief helper function that sends as much of the output of a connection as the socket takes
+    @param c the connection
+    @return 0 if everything was sent, 1 if some is left, -1 if the connection failed
+*/
+int flush(Connection * c) {
+    while (c->out_sent < c->out_len) {
+        ssize_t sent = send(c->fd, c->out + c->out_sent, c->out_len - c->out_sent, MSG_NOSIGNAL);
+
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 1;
+            if (errno == EINTR) continue;
+            return -1;
+        }
+
+        c->out_sent += sent;
+    }
+
+    c->out_len = 0;
+    c->out_sent = 0;
+
+    return 0;
+}
+
+
+/**
+    @brief helper function that answers every whole request in the input of a connection
+    @param c the connection
+    @return 0 on success, -1 if allocation failed
+*/
+int serve_all(Connection * c) {
+    int done = 0;
+
+    while (c->in_len - done >= (int)sizeof(Request)) {
+        Request q;
+        memcpy(&q, c->in + done, sizeof(q));
+        done += sizeof(q);
+
+        if (serve(c, &q) != 0) return -1;
+    }
+
+    memmove(c->in, c->in + done, c->in_len - done);
+    c->in_len -= done;
+
+    return 0;
+}
+
+
+/**
+    @brief helper function that closes a connection
+    @param epoll the epoll instance
+    @param c the connection
+    @return -
+*/
+void disconnect(int epoll, Connection * c) {
+    epoll_ctl(epoll, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    free(c->out);
+    free(c);
+}
+
+
+/**
+    @brief helper function that waits for input or for room to send, depending on the connection
+    @details a connection with unsent responses is not read (back-pressure)
+    @param epoll the epoll instance
+    @param c the connection
+    @return -
+*/
+void watch(int epoll, Connection * c) {
+    struct epoll_event event;
+
+    event.events = (c->out_len > c->out_sent) ? EPOLLOUT : EPOLLIN;
+    event.data.ptr = c;
+
+    epoll_ctl(epoll, EPOLL_CTL_MOD, c->fd, &event);
+}
+
+
+/**
+    @brief helper function that handles an event of a connection
+    @param epoll the epoll instance
+    @param c the connection
+    @param events the events
+    @return 0 to keep the connection, -1 to close it
+*/
+int handle(int epoll, Connection * c, uint32_t events) {
+    if (events & (EPOLLERR | EPOLLHUP) && !(events & EPOLLIN)) return -1;
+
+    if (events & EPOLLOUT) {
+        int left = flush(c);
+        if (left < 0) return -1;
+        if (left > 0) return 0;
+    }
+
+    if (events & EPOLLIN) {
+        ssize_t got = read(c->fd, c->in + c->in_len, SERVER_READ - c->in_len);
+
+        if (got == 0) return -1;
+        if (got < 0) return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+
+        c->in_len += got;
+        if (serve_all(c) != 0) return -1;
+    }
+
+    if (flush(c) < 0) return -1;
+
+    watch(epoll, c);
+
+    return 0;
+}
+
+
+int main(int argc, char ** argv) {
+    const char * path = (argc > 1) ? argv[1] : PROTOCOL_SOCKET;
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Socket path is too long.\n");
+        return 1;
+    }
+
+    strcpy(address.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    unlink(path);
+
+    if (listener == -1 || bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 128) != 0) {
+        perror(path);
+        return 1;
+    }
+
+    int epoll = epoll_create1(0);
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;  // NULL stands for the listening socket
+    epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event);
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    // no messages for every insert() and delete()
+    verbose(0);
+
+    printf("Serving %d trees on %s\n", PROTOCOL_TREES, path);
+    fflush(stdout);
+
+    struct epoll_event events[SERVER_EVENTS];
+
+    while (!Stop) {
+        int ready = epoll_wait(epoll, events, SERVER_EVENTS, -1);
+
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            if (events[i].data.ptr == NULL) {
+                int fd;
+
+                while ((fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK)) != -1) {
+                    Connection * c = (Connection *)calloc(1, sizeof(Connection));
+
+                    if (c == NULL) {
+                        fprintf(stderr, "Unable to allocate memory.\n");
+                        close(fd);
+                        continue;
+                    }
+
+                    c->fd = fd;
+
+                    struct epoll_event added;
+                    added.events = EPOLLIN;
+                    added.data.ptr = c;
+                    epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &added);
+                }
+
+                continue;
+            }
+
+            Connection * c = (Connection *)events[i].data.ptr;
+            if (handle(epoll, c, events[i].events) != 0) disconnect(epoll, c);
+        }
+    }
+
+    // connections are closed with the process; free the trees
+    for (int i = 0; i < PROTOCOL_TREES; i++) {
+        if (Trees[i] == NULL) continue;
+
+        T = Trees[i];
+        destroy();
+    }
+
+    close(epoll);
+    close(listener);
+    unlink(path);
+
+    return 0;
+}
+
+#endif
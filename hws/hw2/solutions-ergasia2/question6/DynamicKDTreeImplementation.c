@@ -0,0 +1,293 @@
+/**
+ * @file DynamicKDTreeImplementation.c
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief kd Tree that supports insert and delete, as a forest of static kd Trees
+*/
+
+#ifndef DYNAMIC_KD_TREE_IMPLEMENTATION_C
+#define DYNAMIC_KD_TREE_IMPLEMENTATION_C
+
+// for memory allocation
+#include <stdlib.h>
+// for stderr use
+#include <stdio.h>
+// all implemented header files in this directory
+#include "DynamicKDTreeInterface.h"
+#include "kdTreeInterface.h"
+#include "PointBufferInterface.h"
+#include "PointInterface.h"
+#include "RangeInterface.h"
+
+// from kdTreeImplementation.c
+void knn_search(KDNode *, Point *, double[KD_DIM], double, int, Neighbour *, int *);
+void knn_finish(Neighbour *, int);
+
+/* ------------------------------ HELPER FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function to mark the leaf of a point as deleted, updating the counts on the way back up
+ * @details a point with the same coordinate as a line may be on either side, so both are tried
+ * @param node the root of the subtree
+ * @param p the point (compared by coordinates)
+ * @return 1 if a live leaf with the point was found and marked, 0 otherwise
+*/
+int tombstone(KDNode * node, Point * p) {
+    if (!node || node->count == 0) return 0;
+
+    if (node->type == LEAF_NODE) {
+        if (!point_equal(node->point, p)) return 0;
+
+        node->count = 0;
+        return 1;
+    }
+
+    double coordinate = p->c[node->type];
+    int found = 0;
+
+    if (coordinate <= node->line) found = tombstone(node->left, p);
+    if (!found && coordinate >= node->line) found = tombstone(node->right, p);
+
+    if (found) node->count--;
+
+    return found;
+}
+
+/**
+ * @brief Function to free the trees of the levels below a level
+ * @param tree the forest
+ * @param levels the number of levels, from level 0
+ * @return -
+*/
+void clear_levels(DynamicKDTree * tree, int levels) {
+    for (int i = 0; i < levels; i++) {
+        if (!tree->trees[i]) continue;
+
+        // the deleted points of these trees are gone for good
+        tree->deleted -= tree->sizes[i] - tree->trees[i]->count;
+
+        destroyKDTree(tree->trees[i]);
+        tree->trees[i] = NULL;
+        tree->sizes[i] = 0;
+    }
+}
+
+/**
+ * @brief Function to rebuild the whole forest as one tree, without the deleted points
+ * @param tree the forest
+ * @return 0 on success, -1 if the tree could not be built (the forest is left as it was)
+*/
+int rebuild(DynamicKDTree * tree) {
+    PointBuffer * b = point_buffer_init(tree->count);
+    if (!b) return -1;
+
+    for (int i = 0; i < DYNAMIC_LEVELS; i++) ReportSubtreeSink(tree->trees[i], point_buffer_add, b);
+
+    // a point that did not fit in the buffer would be lost with the old trees
+    if (b->failed) {
+        point_buffer_destroy(b);
+        return -1;
+    }
+
+    // the smallest level that holds them all
+    int level = 0;
+    while ((1LL << level) < b->count) level++;
+
+    KDNode * root = (b->count > 0) ? buildKDTreeWith(b->points, b->count, BUILD_SELECT) : NULL;
+
+    if (b->count > 0 && !root) {
+        point_buffer_destroy(b);
+        return -1;
+    }
+
+    clear_levels(tree, DYNAMIC_LEVELS);
+
+    tree->trees[level] = root;
+    tree->sizes[level] = b->count;
+
+    point_buffer_destroy(b);
+
+    return 0;
+}
+
+/* ------------------------------ CORE FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function to create an empty dynamic kd Tree
+ * @return A pointer to the tree created
+*/
+DynamicKDTree * createDynamicKDTree(void) {
+    DynamicKDTree * tree = (DynamicKDTree *)calloc(1, sizeof(struct dynamic_kdtree));
+
+    if (!tree) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return NULL;
+    }
+
+    return tree;
+}
+
+/**
+ * @brief Function to insert a point
+ * @details the point and the live points of the levels below the first empty one are
+ * built into one tree on that level, and those levels are emptied. A point is rebuilt
+ * O(log n) times, each time in O(log n) per point, so an insert takes O(log^2 n) amortized
+ * @param tree The dynamic tree
+ * @param p The point (copied)
+ * @return 0 on success, -1 on error
+*/
+int insertDynamicKDTree(DynamicKDTree * tree, Point * p) {
+    if (!tree || !p) return -1;
+
+    int level = 0;
+    while (level < DYNAMIC_LEVELS && tree->trees[level]) level++;
+
+    if (level == DYNAMIC_LEVELS) return -1;
+
+    // room for every point up front, so point_buffer_add() never has to grow the buffer;
+    // if it cannot be allocated, or a point is dropped anyway, the forest is not touched
+    int total = 1;
+    for (int i = 0; i < level; i++) total += tree->trees[i]->count;
+
+    PointBuffer * b = point_buffer_init(total);
+    if (!b) return -1;
+
+    point_buffer_add(p, b);
+    for (int i = 0; i < level; i++) ReportSubtreeSink(tree->trees[i], point_buffer_add, b);
+
+    if (b->failed) {
+        point_buffer_destroy(b);
+        return -1;
+    }
+
+    // build the new tree before freeing the old ones, whose leaves hold the points
+    KDNode * root = buildKDTreeWith(b->points, b->count, BUILD_SELECT);
+    int count = b->count;
+
+    point_buffer_destroy(b);
+
+    if (!root) return -1;
+
+    clear_levels(tree, level);
+
+    tree->trees[level] = root;
+    tree->sizes[level] = count;
+    tree->count++;
+
+    return 0;
+}
+
+/**
+ * @brief Function to delete a point
+ * @details only the leaf is marked (see tombstone()), in O(log^2 n); when more points are
+ * deleted than live, the forest is rebuilt without them
+ * @param tree The dynamic tree
+ * @param p The point, compared by coordinates (one copy is deleted if there are several)
+ * @return 1 if the point was deleted, 0 if it was not in the tree
+*/
+int deleteDynamicKDTree(DynamicKDTree * tree, Point * p) {
+    if (!tree || !p) return 0;
+
+    for (int i = 0; i < DYNAMIC_LEVELS; i++) {
+        if (!tombstone(tree->trees[i], p)) continue;
+
+        tree->count--;
+        tree->deleted++;
+
+        // if the rebuild fails, the deleted points just stay a while longer
+        if (tree->deleted > tree->count) rebuild(tree);
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Function search for points inside a given range in every tree of the forest and report them to a sink
+ * @param tree The dynamic tree
+ * @param range The query range
+ * @param region The region of every tree, it must contain every point inserted (NULL for all of space)
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return -
+*/
+void searchDynamicKDTree(DynamicKDTree * tree, Range * range, Range * region, PointSink sink, void * context) {
+    if (!tree) return;
+
+    for (int i = 0; i < DYNAMIC_LEVELS; i++) searchKDTreeSink(tree->trees[i], range, region, sink, context);
+}
+
+/**
+ * @brief Function to count the points inside a given range in every tree of the forest
+ * @param tree The dynamic tree
+ * @param range The query range
+ * @param region The region of every tree, it must contain every point inserted (NULL for all of space)
+ * @return the number of live points inside the range
+*/
+int countDynamicKDTree(DynamicKDTree * tree, Range * range, Range * region) {
+    if (!tree) return 0;
+
+    int count = 0;
+    for (int i = 0; i < DYNAMIC_LEVELS; i++) count += countKDTree(tree->trees[i], range, region);
+
+    return count;
+}
+
+/**
+ * @brief Function search for points within a distance of a center in every tree of the forest
+ * @param tree The dynamic tree
+ * @param center The center of the circle
+ * @param radius The radius of the circle
+ * @param region The region of every tree, it must contain every point inserted (NULL for all of space)
+ * @param sink Function called for every point inside the circle
+ * @param context Passed on to sink
+ * @return -
+*/
+void radiusDynamicKDTree(DynamicKDTree * tree, Point * center, double radius, Range * region, PointSink sink, void * context) {
+    if (!tree) return;
+
+    for (int i = 0; i < DYNAMIC_LEVELS; i++) radiusKDTree(tree->trees[i], center, radius, region, sink, context);
+}
+
+/**
+ * @brief Function to find the k live points closest to a query point
+ * @details the trees share one heap of candidates, so a close point found in one tree
+ * prunes the search of the next ones
+ * @param tree The dynamic tree
+ * @param query The query point
+ * @param k The number of neighbours wanted
+ * @param out Room for k neighbours, filled closest first, as in knnKDTree()
+ * @return the number of neighbours found
+*/
+int knnDynamicKDTree(DynamicKDTree * tree, Point * query, int k, Neighbour * out) {
+    if (!tree || !query || !out || k <= 0) return 0;
+
+    int size = 0;
+
+    // the largest trees first, they have most of the points
+    for (int i = DYNAMIC_LEVELS - 1; i >= 0; i--) {
+        if (!tree->trees[i]) continue;
+
+        double offset[KD_DIM] = { 0 };
+        knn_search(tree->trees[i], query, offset, 0, k, out, &size);
+    }
+
+    knn_finish(out, size);
+
+    return size;
+}
+
+/**
+ * @brief Function to destroy a dynamic kd Tree
+ * @param tree The dynamic tree
+ * @return -
+*/
+void destroyDynamicKDTree(DynamicKDTree * tree) {
+    if (!tree) return;
+
+    clear_levels(tree, DYNAMIC_LEVELS);
+    free(tree);
+}
+
+#endif
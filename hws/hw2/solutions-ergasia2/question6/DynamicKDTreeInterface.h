@@ -0,0 +1,57 @@
+/**
+ * @file DynamicKDTreeInterface.h
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief kd Tree that supports insert and delete (logarithmic method)
+*/
+
+#ifndef DYNAMIC_KD_TREE_INTERFACE_H
+#define DYNAMIC_KD_TREE_INTERFACE_H
+
+#include "PointInterface.h"
+#include "RangeInterface.h"
+#include "kdTreeInterface.h"
+
+// one more than the most levels that an int number of points needs
+#define DYNAMIC_LEVELS 32
+
+// A forest of static trees (built by buildKDTreeWith()), where the tree
+// of level i holds at most 2^i points. An insert builds one tree from
+// the new point and all the trees of the levels below the first empty
+// one, like adding 1 to a binary counter.
+//
+// A delete only marks the leaf of the point: its count becomes 0 and
+// the counts of the nodes above it go down by one, so every query of
+// kdTreeInterface.h skips it. When there are more deleted points than
+// live ones, the whole forest is rebuilt without them.
+typedef struct dynamic_kdtree {
+    // NULL for an empty level
+    KDNode * trees[DYNAMIC_LEVELS];
+
+    // points stored in the tree of every level, live or deleted
+    int sizes[DYNAMIC_LEVELS];
+
+    // live points
+    int count;
+
+    // deleted points still in the trees
+    int deleted;
+} DynamicKDTree;
+
+DynamicKDTree * createDynamicKDTree(void);
+
+int insertDynamicKDTree(DynamicKDTree *, Point *);
+
+int deleteDynamicKDTree(DynamicKDTree *, Point *);
+
+void searchDynamicKDTree(DynamicKDTree *, Range *, Range *, PointSink, void *);
+
+int countDynamicKDTree(DynamicKDTree *, Range *, Range *);
+
+void radiusDynamicKDTree(DynamicKDTree *, Point *, double, Range *, PointSink, void *);
+
+int knnDynamicKDTree(DynamicKDTree *, Point *, int, Neighbour *);
+
+void destroyDynamicKDTree(DynamicKDTree *);
+
+#endif
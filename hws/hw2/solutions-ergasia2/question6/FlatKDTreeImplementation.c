@@ -0,0 +1,928 @@
+/**
+ * @file FlatKDTreeImplementation.c
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief kd Tree stored in arrays instead of linked nodes
+*/
+
+#ifndef FLAT_KD_TREE_IMPLEMENTATION_C
+#define FLAT_KD_TREE_IMPLEMENTATION_C
+
+// for memory allocation
+#include <stdlib.h>
+// for stderr use and for saving a tree
+#include <stdio.h>
+// for comparing the file's magic
+#include <string.h>
+// for opening a saved tree
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+// the leaf filters have an AVX2 version on x86, compiled for AVX2 whatever the flags
+// of the file and only called if the CPU has it (__builtin_cpu_supports())
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FLAT_AVX2
+#include <immintrin.h>
+#endif
+// all implemented header files in this directory
+#include "FlatKDTreeInterface.h"
+#include "kdTreeInterface.h"
+#include "PointInterface.h"
+#include "RangeInterface.h"
+
+// from kdTreeImplementation.c
+void select_point(Point **, int, int, int);
+
+// largest quantized coordinate of FLAT_QUANT16 and FLAT_QUANT32
+#define FLAT_TOP16 65535.0
+#define FLAT_TOP32 4294967295.0
+
+// first bytes of a saved tree
+#define FLAT_MAGIC "KDFLAT02"
+
+// arrays in a saved tree start at multiples of this
+#define FLAT_ALIGN 64
+
+// The start of a saved tree, followed by the arrays line, points and the
+// coordinates of every axis (in the tree's storage), each one aligned to FLAT_ALIGN.
+// The tables of internal nodes are not saved, they are recomputed from n and bucket.
+struct flat_header {
+    char magic[8];
+
+    // KD_DIM of the program that saved it
+    int dim;
+
+    int n;
+    int bucket;
+    int storage;
+
+    double low[KD_DIM];
+    double scale[KD_DIM];
+
+    Range bounds;
+};
+
+// A range in the form of the tree's storage. A point whose stored coordinates
+// are all in [min, max] may be inside the range, in (min, max) it surely is.
+struct flat_keys {
+    float fmin[KD_DIM], fmax[KD_DIM];
+    uint32_t qmin[KD_DIM], qmax[KD_DIM];
+};
+
+/* ------------------------------ HELPER FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function that returns the number of internal nodes of a subtree
+ * @param tree the tree (its table has to be filled)
+ * @param n the number of points in the subtree
+ * @param depth depth of the subtree
+ * @return the number of internal nodes
+*/
+int flat_internal(FlatKDTree * tree, int n, int depth) {
+    return tree->internal[2 * depth + (n - tree->size_lo[depth])];
+}
+
+/**
+ * @brief Function to fill the table of internal nodes, from the deepest level up
+ * @param tree the tree (n and bucket have to be set)
+ * @return -
+*/
+void fill_internal(FlatKDTree * tree) {
+    // the first depth whose subtrees have at most one point
+    int deepest = 0;
+    while (tree->n >> deepest) deepest++;
+
+    for (int d = deepest; d >= 0; d--) {
+        tree->size_lo[d] = tree->n >> d;
+
+        for (int k = 0; k < 2; k++) {
+            int n = tree->size_lo[d] + k;
+
+            tree->internal[2 * d + k] = (n <= tree->bucket) ? 0 :
+                1 + flat_internal(tree, (n + 1) / 2, d + 1) + flat_internal(tree, n / 2, d + 1);
+        }
+    }
+}
+
+/**
+ * @brief Function to quantize a coordinate relative to the bounding box of the tree
+ * @details it never decreases when c grows (the same operations for the points and for
+ * the bounds of a range), which is what makes the quantized range tests safe
+ * @param tree the tree (low and scale have to be set)
+ * @param axis the axis of the coordinate
+ * @param c the coordinate
+ * @param top the largest quantized value (FLAT_TOP16 or FLAT_TOP32)
+ * @return floor((c - low) * scale), limited to [0, top]
+*/
+uint32_t flat_quantize(FlatKDTree * tree, int axis, double c, double top) {
+    double t = (c - tree->low[axis]) * tree->scale[axis];
+
+    // also for NaN
+    if (!(t > 0)) return 0;
+    if (t >= top) return (uint32_t)top;
+
+    return (uint32_t)t;
+}
+
+/**
+ * @brief Function to fill the arrays of a subtree, choosing the median the same way as buildKDTree()
+ * @param tree the tree being built
+ * @param points the points of the subtree, reordered
+ * @param n the number of points in the subtree
+ * @param depth depth of the subtree
+ * @param i index of the subtree's root among the internal nodes
+ * @param lo position of the subtree's first point
+ * @return -
+*/
+void build_flat(FlatKDTree * tree, Point ** points, int n, int depth, int i, int lo) {
+    if (n <= tree->bucket) {
+        for (int k = 0; k < n; k++) {
+            tree->points[lo + k] = *points[k];
+            for (int d = 0; d < KD_DIM; d++) {
+                double c = points[k]->c[d];
+
+                switch (tree->storage) {
+                    case FLAT_DOUBLE: tree->coords[d][lo + k] = c; break;
+                    case FLAT_FLOAT: tree->fcoords[d][lo + k] = (float)c; break;
+                    case FLAT_QUANT32: tree->q32[d][lo + k] = flat_quantize(tree, d, c, FLAT_TOP32); break;
+                    case FLAT_QUANT16: tree->q16[d][lo + k] = (uint16_t)flat_quantize(tree, d, c, FLAT_TOP16); break;
+                }
+            }
+        }
+        return;
+    }
+
+    int axis = depth % KD_DIM;
+    int m = (n + 1) / 2;
+
+    // the m-th point is the median, the first m go left
+    select_point(points, n, m - 1, axis);
+
+    tree->line[i] = points[m - 1]->c[axis];
+
+    build_flat(tree, points, m, depth + 1, i + 1, lo);
+    build_flat(tree, points + m, n - m, depth + 1, i + 1 + flat_internal(tree, m, depth + 1), lo + m);
+}
+
+/**
+ * @brief Function to report the points of a subtree, which are next to each other
+ * @param tree the tree
+ * @param lo position of the first point
+ * @param n number of points
+ * @param sink Function called for every point
+ * @param context Passed on to sink
+ * @return -
+*/
+void report_flat(FlatKDTree * tree, int lo, int n, PointSink sink, void * context) {
+    for (int k = lo; k < lo + n; k++) sink(&tree->points[k], context);
+}
+
+#ifdef FLAT_AVX2
+/**
+ * @brief Function to check the points of a leaf four at a time with AVX2, the vector part of filter_flat()
+ * @details compiled for AVX2 whatever the flags of the file, so it is only called if the CPU has it
+ * @param tree the tree
+ * @param range the query range
+ * @param lo position of the leaf's first point
+ * @param n number of points in the leaf
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return the number of points checked (a multiple of four), the rest are left to the caller
+*/
+__attribute__((target("avx2")))
+int filter_flat_avx2(FlatKDTree * tree, Range * range, int lo, int n, PointSink sink, void * context) {
+    int k = 0;
+
+    // the bounds of the range on every axis, four copies of each
+#define BOUNDS_ON(i) __m256d min##i = _mm256_set1_pd(range->b[i][0]), max##i = _mm256_set1_pd(range->b[i][1]);
+    KD_EACH(BOUNDS_ON)
+#undef BOUNDS_ON
+
+    __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+    for (; k + 4 <= n; k += 4) {
+        __m256d in = all;
+
+#define INSIDE_ON(i) { \
+            __m256d v = _mm256_loadu_pd(tree->coords[i] + lo + k); \
+            in = _mm256_and_pd(in, _mm256_and_pd(_mm256_cmp_pd(v, min##i, _CMP_GE_OQ), _mm256_cmp_pd(v, max##i, _CMP_LE_OQ))); \
+        }
+        KD_EACH(INSIDE_ON)
+#undef INSIDE_ON
+
+        // one bit for every point inside the range
+        int mask = _mm256_movemask_pd(in);
+
+        while (mask) {
+            int bit = __builtin_ctz(mask);
+            sink(&tree->points[lo + k + bit], context);
+            mask &= mask - 1;
+        }
+    }
+
+    return k;
+}
+#endif
+
+/**
+ * @brief Function to report the points of a leaf that are inside a range,
+ * same test as point_in_range(), four points at a time with AVX2 if the CPU has it (one compare pair per axis)
+ * @param tree the tree
+ * @param range the query range
+ * @param lo position of the leaf's first point
+ * @param n number of points in the leaf
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return -
+*/
+void filter_flat(FlatKDTree * tree, Range * range, int lo, int n, PointSink sink, void * context) {
+    int k = 0;
+
+#ifdef FLAT_AVX2
+    if (__builtin_cpu_supports("avx2")) k = filter_flat_avx2(tree, range, lo, n, sink, context);
+#endif
+
+    for (; k < n; k++) {
+#define INSIDE_ON(i) && tree->coords[i][lo + k] >= range->b[i][0] && tree->coords[i][lo + k] <= range->b[i][1]
+        if (1 KD_EACH(INSIDE_ON))
+            sink(&tree->points[lo + k], context);
+#undef INSIDE_ON
+    }
+}
+
+/**
+ * @brief Function to report the points of a leaf picked by the rounded range test
+ * @param tree the tree
+ * @param range the exact query range
+ * @param first position of the first of the points tested together
+ * @param maybe one bit for every point that may be inside the range
+ * @param sure one bit for every point that is surely inside (no exact check)
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return -
+*/
+void report_masked(FlatKDTree * tree, Range * range, int first, unsigned maybe, unsigned sure, PointSink sink, void * context) {
+    while (maybe) {
+        int bit = __builtin_ctz(maybe);
+        Point * p = &tree->points[first + bit];
+
+        if (((sure >> bit) & 1) || point_in_range(p, range)) sink(p, context);
+
+        maybe &= maybe - 1;
+    }
+}
+
+#ifdef FLAT_AVX2
+/**
+ * @brief Function to check the points of a leaf eight at a time with AVX2, the vector part of filter_flat_float()
+ * @details compiled for AVX2 whatever the flags of the file, so it is only called if the CPU has it
+ * @param tree the tree
+ * @param range the query range
+ * @param keys the range as floats
+ * @param lo position of the leaf's first point
+ * @param n number of points in the leaf
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return the number of points checked (a multiple of eight), the rest are left to the caller
+*/
+__attribute__((target("avx2")))
+int filter_flat_float_avx2(FlatKDTree * tree, Range * range, struct flat_keys * keys, int lo, int n, PointSink sink, void * context) {
+    int k = 0;
+
+#define BOUNDS_ON(i) __m256 min##i = _mm256_set1_ps(keys->fmin[i]), max##i = _mm256_set1_ps(keys->fmax[i]);
+    KD_EACH(BOUNDS_ON)
+#undef BOUNDS_ON
+
+    __m256 all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+    for (; k + 8 <= n; k += 8) {
+        __m256 maybe = all, sure = all;
+
+#define INSIDE_ON(i) { \
+            __m256 v = _mm256_loadu_ps(tree->fcoords[i] + lo + k); \
+            maybe = _mm256_and_ps(maybe, _mm256_and_ps(_mm256_cmp_ps(v, min##i, _CMP_GE_OQ), _mm256_cmp_ps(v, max##i, _CMP_LE_OQ))); \
+            sure = _mm256_and_ps(sure, _mm256_and_ps(_mm256_cmp_ps(v, min##i, _CMP_GT_OQ), _mm256_cmp_ps(v, max##i, _CMP_LT_OQ))); \
+        }
+        KD_EACH(INSIDE_ON)
+#undef INSIDE_ON
+
+        report_masked(tree, range, lo + k, _mm256_movemask_ps(maybe), _mm256_movemask_ps(sure), sink, context);
+    }
+
+    return k;
+}
+#endif
+
+/**
+ * @brief Function to report the points of a leaf that are inside a range, with float coordinates
+ * @details eight points at a time with AVX2 if the CPU has it. (float)c never decreases when c grows, so a point
+ * inside the range has its floats in [(float)min, (float)max]; only the ones on these bounds are checked exactly
+ * @param tree the tree
+ * @param range the query range
+ * @param keys the range as floats
+ * @param lo position of the leaf's first point
+ * @param n number of points in the leaf
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return -
+*/
+void filter_flat_float(FlatKDTree * tree, Range * range, struct flat_keys * keys, int lo, int n, PointSink sink, void * context) {
+    int k = 0;
+
+#ifdef FLAT_AVX2
+    if (__builtin_cpu_supports("avx2")) k = filter_flat_float_avx2(tree, range, keys, lo, n, sink, context);
+#endif
+
+    for (; k < n; k++) {
+        int maybe = 1, sure = 1;
+
+#define INSIDE_ON(i) { \
+            float v = tree->fcoords[i][lo + k]; \
+            maybe &= (v >= keys->fmin[i]) & (v <= keys->fmax[i]); \
+            sure &= (v > keys->fmin[i]) & (v < keys->fmax[i]); \
+        }
+        KD_EACH(INSIDE_ON)
+#undef INSIDE_ON
+
+        report_masked(tree, range, lo + k, maybe, sure, sink, context);
+    }
+}
+
+#ifdef FLAT_AVX2
+/**
+ * @brief Function to check the points of a leaf eight at a time with AVX2, the vector part of filter_flat_q32()
+ * @details compiled for AVX2 whatever the flags of the file, so it is only called if the CPU has it
+ * @param tree the tree
+ * @param range the query range
+ * @param keys the range quantized
+ * @param lo position of the leaf's first point
+ * @param n number of points in the leaf
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return the number of points checked (a multiple of eight), the rest are left to the caller
+*/
+__attribute__((target("avx2")))
+int filter_flat_q32_avx2(FlatKDTree * tree, Range * range, struct flat_keys * keys, int lo, int n, PointSink sink, void * context) {
+    int k = 0;
+
+#define BOUNDS_ON(i) __m256i min##i = _mm256_set1_epi32((int)keys->qmin[i]), max##i = _mm256_set1_epi32((int)keys->qmax[i]);
+    KD_EACH(BOUNDS_ON)
+#undef BOUNDS_ON
+
+    __m256i all = _mm256_set1_epi32(-1);
+
+    for (; k + 8 <= n; k += 8) {
+        __m256i maybe = all, unsure = _mm256_setzero_si256();
+
+        // v >= min: max(v, min) == v, v <= min: min(v, min) == v (the same for max)
+#define INSIDE_ON(i) { \
+            __m256i v = _mm256_loadu_si256((const __m256i *)(tree->q32[i] + lo + k)); \
+            maybe = _mm256_and_si256(maybe, _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_max_epu32(v, min##i), v), \
+                                                             _mm256_cmpeq_epi32(_mm256_min_epu32(v, max##i), v))); \
+            unsure = _mm256_or_si256(unsure, _mm256_or_si256(_mm256_cmpeq_epi32(_mm256_min_epu32(v, min##i), v), \
+                                                             _mm256_cmpeq_epi32(_mm256_max_epu32(v, max##i), v))); \
+        }
+        KD_EACH(INSIDE_ON)
+#undef INSIDE_ON
+
+        unsigned m = _mm256_movemask_ps(_mm256_castsi256_ps(maybe));
+        unsigned u = _mm256_movemask_ps(_mm256_castsi256_ps(unsure));
+
+        report_masked(tree, range, lo + k, m, ~u, sink, context);
+    }
+
+    return k;
+}
+#endif
+
+/**
+ * @brief Function to report the points of a leaf that are inside a range, with 32-bit quantized coordinates
+ * @details eight points at a time with AVX2 if the CPU has it (unsigned compares made of min/max and equality)
+ * @param tree the tree
+ * @param range the query range
+ * @param keys the range quantized
+ * @param lo position of the leaf's first point
+ * @param n number of points in the leaf
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return -
+*/
+void filter_flat_q32(FlatKDTree * tree, Range * range, struct flat_keys * keys, int lo, int n, PointSink sink, void * context) {
+    int k = 0;
+
+#ifdef FLAT_AVX2
+    if (__builtin_cpu_supports("avx2")) k = filter_flat_q32_avx2(tree, range, keys, lo, n, sink, context);
+#endif
+
+    for (; k < n; k++) {
+        int maybe = 1, sure = 1;
+
+#define INSIDE_ON(i) { \
+            uint32_t v = tree->q32[i][lo + k]; \
+            maybe &= (v >= keys->qmin[i]) & (v <= keys->qmax[i]); \
+            sure &= (v > keys->qmin[i]) & (v < keys->qmax[i]); \
+        }
+        KD_EACH(INSIDE_ON)
+#undef INSIDE_ON
+
+        report_masked(tree, range, lo + k, maybe, sure, sink, context);
+    }
+}
+
+#ifdef FLAT_AVX2
+/**
+ * @brief Function to check the points of a leaf sixteen at a time with AVX2, the vector part of filter_flat_q16()
+ * @details compiled for AVX2 whatever the flags of the file, so it is only called if the CPU has it
+ * @param tree the tree
+ * @param range the query range
+ * @param keys the range quantized
+ * @param lo position of the leaf's first point
+ * @param n number of points in the leaf
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return the number of points checked (a multiple of sixteen), the rest are left to the caller
+*/
+__attribute__((target("avx2")))
+int filter_flat_q16_avx2(FlatKDTree * tree, Range * range, struct flat_keys * keys, int lo, int n, PointSink sink, void * context) {
+    int k = 0;
+
+#define BOUNDS_ON(i) __m256i min##i = _mm256_set1_epi16((short)keys->qmin[i]), max##i = _mm256_set1_epi16((short)keys->qmax[i]);
+    KD_EACH(BOUNDS_ON)
+#undef BOUNDS_ON
+
+    __m256i all = _mm256_set1_epi16(-1);
+
+    for (; k + 16 <= n; k += 16) {
+        __m256i maybe = all, unsure = _mm256_setzero_si256();
+
+#define INSIDE_ON(i) { \
+            __m256i v = _mm256_loadu_si256((const __m256i *)(tree->q16[i] + lo + k)); \
+            maybe = _mm256_and_si256(maybe, _mm256_and_si256(_mm256_cmpeq_epi16(_mm256_max_epu16(v, min##i), v), \
+                                                             _mm256_cmpeq_epi16(_mm256_min_epu16(v, max##i), v))); \
+            unsure = _mm256_or_si256(unsure, _mm256_or_si256(_mm256_cmpeq_epi16(_mm256_min_epu16(v, min##i), v), \
+                                                             _mm256_cmpeq_epi16(_mm256_max_epu16(v, max##i), v))); \
+        }
+        KD_EACH(INSIDE_ON)
+#undef INSIDE_ON
+
+        // one byte for every 16-bit result, in order, then one bit for every byte
+        unsigned m = _mm_movemask_epi8(_mm_packs_epi16(_mm256_castsi256_si128(maybe), _mm256_extracti128_si256(maybe, 1)));
+        unsigned u = _mm_movemask_epi8(_mm_packs_epi16(_mm256_castsi256_si128(unsure), _mm256_extracti128_si256(unsure, 1)));
+
+        report_masked(tree, range, lo + k, m, ~u, sink, context);
+    }
+
+    return k;
+}
+#endif
+
+/**
+ * @brief Function to report the points of a leaf that are inside a range, with 16-bit quantized coordinates
+ * @details sixteen points at a time with AVX2 if the CPU has it, same tests as filter_flat_q32()
+ * @param tree the tree
+ * @param range the query range
+ * @param keys the range quantized
+ * @param lo position of the leaf's first point
+ * @param n number of points in the leaf
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return -
+*/
+void filter_flat_q16(FlatKDTree * tree, Range * range, struct flat_keys * keys, int lo, int n, PointSink sink, void * context) {
+    int k = 0;
+
+#ifdef FLAT_AVX2
+    if (__builtin_cpu_supports("avx2")) k = filter_flat_q16_avx2(tree, range, keys, lo, n, sink, context);
+#endif
+
+    for (; k < n; k++) {
+        int maybe = 1, sure = 1;
+
+#define INSIDE_ON(i) { \
+            uint32_t v = tree->q16[i][lo + k]; \
+            maybe &= (v >= keys->qmin[i]) & (v <= keys->qmax[i]); \
+            sure &= (v > keys->qmin[i]) & (v < keys->qmax[i]); \
+        }
+        KD_EACH(INSIDE_ON)
+#undef INSIDE_ON
+
+        report_masked(tree, range, lo + k, maybe, sure, sink, context);
+    }
+}
+
+/**
+ * @brief Function to search a subtree, same algorithm as searchKDTreeSink()
+ * @param tree the tree
+ * @param range the query range
+ * @param keys the query range in the form of the tree's storage (not used with FLAT_DOUBLE)
+ * @param region the region of the subtree
+ * @param i index of the subtree's root among the internal nodes
+ * @param lo position of the subtree's first point
+ * @param n number of points in the subtree
+ * @param depth depth of the subtree
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return -
+*/
+void search_flat(FlatKDTree * tree, Range * range, struct flat_keys * keys, Range * region, int i, int lo, int n, int depth, PointSink sink, void * context) {
+    if (n <= tree->bucket) {
+        switch (tree->storage) {
+            case FLAT_DOUBLE: filter_flat(tree, range, lo, n, sink, context); break;
+            case FLAT_FLOAT: filter_flat_float(tree, range, keys, lo, n, sink, context); break;
+            case FLAT_QUANT32: filter_flat_q32(tree, range, keys, lo, n, sink, context); break;
+            case FLAT_QUANT16: filter_flat_q16(tree, range, keys, lo, n, sink, context); break;
+        }
+        return;
+    }
+
+    int m = (n + 1) / 2;
+    double line = tree->line[i];
+
+    Range lc_region = region_below(region, depth % KD_DIM, line);
+
+    if (range_contains(range, &lc_region)) {
+        report_flat(tree, lo, m, sink, context);
+    } else if (range_intersect(range, &lc_region)) {
+        search_flat(tree, range, keys, &lc_region, i + 1, lo, m, depth + 1, sink, context);
+    }
+
+    Range rc_region = region_above(region, depth % KD_DIM, line);
+
+    if (range_contains(range, &rc_region)) {
+        report_flat(tree, lo + m, n - m, sink, context);
+    } else if (range_intersect(range, &rc_region)) {
+        search_flat(tree, range, keys, &rc_region, i + 1 + flat_internal(tree, m, depth + 1), lo + m, n - m, depth + 1, sink, context);
+    }
+}
+
+/**
+ * @brief Function that returns the size of one stored coordinate
+ * @param storage the storage of the tree
+ * @return the size in bytes
+*/
+size_t flat_coordinate_size(FlatStorage storage) {
+    switch (storage) {
+        case FLAT_DOUBLE: return sizeof(double);
+        case FLAT_FLOAT: return sizeof(float);
+        case FLAT_QUANT32: return sizeof(uint32_t);
+        case FLAT_QUANT16: return sizeof(uint16_t);
+    }
+    return 0;
+}
+
+/**
+ * @brief Function that returns the array of stored coordinates of an axis, whatever the storage
+ * @param tree the tree
+ * @param axis the axis
+ * @return the array
+*/
+void * flat_coordinates(FlatKDTree * tree, int axis) {
+    switch (tree->storage) {
+        case FLAT_DOUBLE: return tree->coords[axis];
+        case FLAT_FLOAT: return tree->fcoords[axis];
+        case FLAT_QUANT32: return tree->q32[axis];
+        case FLAT_QUANT16: return tree->q16[axis];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Function that finds where every array of a tree is in a saved tree
+ * @param tree the tree (n, bucket, storage and the table of internal nodes have to be set)
+ * @param line position of the lines
+ * @param points position of the points
+ * @param coords position of the coordinates of every axis
+ * @return the size of the file
+*/
+size_t flat_layout(FlatKDTree * tree, size_t * line, size_t * points, size_t coords[KD_DIM]) {
+    size_t internal = flat_internal(tree, tree->n, 0);
+    size_t at = sizeof(struct flat_header);
+
+    // the next multiple of FLAT_ALIGN
+#define FLAT_NEXT(x) (((x) + FLAT_ALIGN - 1) / FLAT_ALIGN * FLAT_ALIGN)
+
+    *line = FLAT_NEXT(at);
+    at = *line + internal * sizeof(double);
+
+    *points = FLAT_NEXT(at);
+    at = *points + tree->n * sizeof(Point);
+
+    for (int d = 0; d < KD_DIM; d++) {
+        coords[d] = FLAT_NEXT(at);
+        at = coords[d] + tree->n * flat_coordinate_size(tree->storage);
+    }
+
+#undef FLAT_NEXT
+
+    return at;
+}
+
+/**
+ * @brief Function to write an array at a position of a file, with zeros before it
+ * @param file the file
+ * @param at the position (not before the current one)
+ * @param data the array
+ * @param size the size of the array in bytes
+ * @return 1 on success, 0 on a write error
+*/
+int flat_write_at(FILE * file, size_t at, const void * data, size_t size) {
+    for (long k = ftell(file); k >= 0 && (size_t)k < at; k++)
+        if (fputc(0, file) == EOF) return 0;
+
+    return fwrite(data, 1, size, file) == size;
+}
+
+/* ------------------------------ CORE FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function to build a flat kd Tree, the same tree as buildKDTree() in arrays
+ * @param points the set of points, reordered (the points themselves are copied)
+ * @param n the number of points in 'points'
+ * @return A pointer to the tree created
+*/
+FlatKDTree * buildFlatKDTree(Point ** points, int n) {
+    return buildFlatKDTreeBuckets(points, n, 1);
+}
+
+/**
+ * @brief Function to build a flat kd Tree whose leaves hold up to 'bucket' points
+ * @param points the set of points, reordered (the points themselves are copied)
+ * @param n the number of points in 'points'
+ * @param bucket the most points in a leaf (1 gives the tree of buildKDTree())
+ * @return A pointer to the tree created
+*/
+FlatKDTree * buildFlatKDTreeBuckets(Point ** points, int n, int bucket) {
+    return buildFlatKDTreeStorage(points, n, bucket, FLAT_DOUBLE);
+}
+
+/**
+ * @brief Function to build a flat kd Tree whose leaves hold up to 'bucket' points, with the
+ * coordinates of the leaf filter stored as 'storage'
+ * @details the exact points are kept in 'points' for the re-checks and for the sink. The quantized
+ * modes map the bounding box of the points to [0, 2^bits - 1] on every axis
+ * @param points the set of points, reordered (the points themselves are copied)
+ * @param n the number of points in 'points'
+ * @param bucket the most points in a leaf (1 gives the tree of buildKDTree())
+ * @param storage FLAT_DOUBLE, FLAT_FLOAT, FLAT_QUANT32 or FLAT_QUANT16
+ * @return A pointer to the tree created
+*/
+FlatKDTree * buildFlatKDTreeStorage(Point ** points, int n, int bucket, FlatStorage storage) {
+    if (!points || n <= 0 || bucket < 1) return NULL;
+
+    FlatKDTree * tree = (FlatKDTree *)malloc(sizeof(struct flat_kdtree));
+    int ok = (tree != NULL);
+
+    if (tree) {
+        tree->n = n;
+        tree->bucket = bucket;
+        tree->storage = storage;
+        tree->map = NULL;
+        fill_internal(tree);
+
+        int internal = flat_internal(tree, n, 0);
+
+        tree->line = (double *)malloc((internal > 0 ? internal : 1) * sizeof(double));
+        tree->points = (Point *)malloc(n * sizeof(Point));
+        ok = tree->line && tree->points;
+
+        for (int d = 0; d < KD_DIM; d++) {
+            tree->coords[d] = (storage == FLAT_DOUBLE) ? (double *)malloc(n * sizeof(double)) : NULL;
+            tree->fcoords[d] = (storage == FLAT_FLOAT) ? (float *)malloc(n * sizeof(float)) : NULL;
+            tree->q32[d] = (storage == FLAT_QUANT32) ? (uint32_t *)malloc(n * sizeof(uint32_t)) : NULL;
+            tree->q16[d] = (storage == FLAT_QUANT16) ? (uint16_t *)malloc(n * sizeof(uint16_t)) : NULL;
+
+            if (!tree->coords[d] && !tree->fcoords[d] && !tree->q32[d] && !tree->q16[d]) ok = 0;
+        }
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        destroyFlatKDTree(tree);
+        return NULL;
+    }
+
+    // the bounding box of the points, the region of the root and the box of the quantized modes
+    double top = (storage == FLAT_QUANT16) ? FLAT_TOP16 : FLAT_TOP32;
+    tree->bounds = range_bounding(points, n);
+
+    for (int d = 0; d < KD_DIM; d++) {
+        double low = tree->bounds.b[d][0], high = tree->bounds.b[d][1];
+
+        tree->low[d] = low;
+        tree->scale[d] = (high > low) ? top / (high - low) : 0;
+    }
+
+    build_flat(tree, points, n, 0, 0, 0);
+
+    return tree;
+}
+
+/**
+ * @brief Function search for points inside a given range and report them to a sink
+ * @details the points reported are the ones stored in the tree; a subtree fully inside
+ * the range is reported with one pass over its points. With the float and quantized modes the
+ * range is rounded the same way as the coordinates once per query
+ * @param tree The tree
+ * @param range The query range
+ * @param region The region of the whole tree (NULL for the bounding box of the points)
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return -
+*/
+void searchFlatKDTree(FlatKDTree * tree, Range * range, Range * region, PointSink sink, void * context) {
+    if (!tree || !sink) return;
+
+    struct flat_keys keys;
+    double top = (tree->storage == FLAT_QUANT16) ? FLAT_TOP16 : FLAT_TOP32;
+
+    for (int d = 0; d < KD_DIM; d++) {
+        keys.fmin[d] = (float)range->b[d][0];
+        keys.fmax[d] = (float)range->b[d][1];
+        keys.qmin[d] = flat_quantize(tree, d, range->b[d][0], top);
+        keys.qmax[d] = flat_quantize(tree, d, range->b[d][1], top);
+    }
+
+    if (!region) region = &tree->bounds;
+
+    search_flat(tree, range, &keys, region, 0, 0, tree->n, 0, sink, context);
+}
+
+/**
+ * @brief Function that returns the memory used by a flat kd Tree
+ * @param tree The tree
+ * @return the number of bytes allocated for the tree and its arrays
+*/
+size_t flatKDTreeMemory(FlatKDTree * tree) {
+    if (!tree) return 0;
+
+    size_t internal = flat_internal(tree, tree->n, 0);
+
+    return sizeof(struct flat_kdtree) + internal * sizeof(double) + tree->n * (sizeof(Point) + KD_DIM * flat_coordinate_size(tree->storage));
+}
+
+/**
+ * @brief Function to save a flat kd Tree to a file, as it is in memory
+ * @details the file is an image of the tree without pointers (see struct flat_header),
+ * so openFlatKDTree() can use it without reading or rebuilding anything
+ * @param tree The tree
+ * @param path The file to write (replaced if it exists)
+ * @return 1 on success, 0 on failure
+*/
+int saveFlatKDTree(FlatKDTree * tree, const char * path) {
+    if (!tree || !path) return 0;
+
+    FILE * file = fopen(path, "wb");
+
+    if (!file) {
+        fprintf(stderr, "Unable to open %s.\n", path);
+        return 0;
+    }
+
+    struct flat_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FLAT_MAGIC, sizeof(header.magic));
+    header.dim = KD_DIM;
+    header.n = tree->n;
+    header.bucket = tree->bucket;
+    header.storage = tree->storage;
+
+    for (int d = 0; d < KD_DIM; d++) {
+        header.low[d] = tree->low[d];
+        header.scale[d] = tree->scale[d];
+    }
+
+    header.bounds = tree->bounds;
+
+    size_t line, points, coords[KD_DIM];
+    flat_layout(tree, &line, &points, coords);
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && flat_write_at(file, line, tree->line, flat_internal(tree, tree->n, 0) * sizeof(double));
+    ok = ok && flat_write_at(file, points, tree->points, tree->n * sizeof(Point));
+
+    for (int d = 0; ok && d < KD_DIM; d++)
+        ok = flat_write_at(file, coords[d], flat_coordinates(tree, d), tree->n * flat_coordinate_size(tree->storage));
+
+    if (fclose(file) != 0) ok = 0;
+
+    if (!ok) fprintf(stderr, "Unable to write %s.\n", path);
+
+    return ok;
+}
+
+/**
+ * @brief Function to open a flat kd Tree saved by saveFlatKDTree()
+ * @details the file is mapped read-only and the arrays of the tree point into the mapping,
+ * so opening takes the same time for any number of points; the pages are read by the
+ * queries that need them. The tree must not be changed, and is closed with destroyFlatKDTree()
+ * @param path The file
+ * @return A pointer to the tree, NULL if the file can't be opened or isn't a saved tree of this KD_DIM
+*/
+FlatKDTree * openFlatKDTree(const char * path) {
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        fprintf(stderr, "Unable to open %s.\n", path);
+        return NULL;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(struct flat_header)) {
+        fprintf(stderr, "%s is not a saved kd Tree of %d coordinates.\n", path, KD_DIM);
+        close(fd);
+        return NULL;
+    }
+
+    void * map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping stays valid after the file is closed
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Unable to map %s.\n", path);
+        return NULL;
+    }
+
+    const struct flat_header * header = (const struct flat_header *)map;
+    FlatKDTree * tree = NULL;
+
+    int ok = memcmp(header->magic, FLAT_MAGIC, sizeof(header->magic)) == 0 && header->dim == KD_DIM &&
+             header->n > 0 && header->bucket >= 1 && header->storage >= FLAT_DOUBLE && header->storage <= FLAT_QUANT16;
+
+    if (ok) {
+        tree = (FlatKDTree *)malloc(sizeof(struct flat_kdtree));
+
+        if (!tree) {
+            fprintf(stderr, "Unable to allocate memory.\n");
+            munmap(map, info.st_size);
+            return NULL;
+        }
+
+        tree->n = header->n;
+        tree->bucket = header->bucket;
+        tree->storage = (FlatStorage)header->storage;
+        tree->map = map;
+        tree->map_size = info.st_size;
+        tree->bounds = header->bounds;
+        fill_internal(tree);
+
+        size_t line, points, coords[KD_DIM];
+        ok = flat_layout(tree, &line, &points, coords) == (size_t)info.st_size;
+
+        // the tree is only read, the casts drop the const of the mapping
+        tree->line = (double *)((char *)map + line);
+        tree->points = (Point *)((char *)map + points);
+
+        for (int d = 0; d < KD_DIM; d++) {
+            void * array = (char *)map + coords[d];
+
+            tree->coords[d] = (tree->storage == FLAT_DOUBLE) ? (double *)array : NULL;
+            tree->fcoords[d] = (tree->storage == FLAT_FLOAT) ? (float *)array : NULL;
+            tree->q32[d] = (tree->storage == FLAT_QUANT32) ? (uint32_t *)array : NULL;
+            tree->q16[d] = (tree->storage == FLAT_QUANT16) ? (uint16_t *)array : NULL;
+            tree->low[d] = header->low[d];
+            tree->scale[d] = header->scale[d];
+        }
+    }
+
+    if (!ok) {
+        fprintf(stderr, "%s is not a saved kd Tree of %d coordinates.\n", path, KD_DIM);
+        free(tree);
+        munmap(map, info.st_size);
+        return NULL;
+    }
+
+    return tree;
+}
+
+/**
+ * @brief Function to destroy a flat kd Tree
+ * @param tree The tree
+ * @return -
+*/
+void destroyFlatKDTree(FlatKDTree * tree) {
+    if (!tree) return;
+
+    // an opened tree: its arrays are in the mapping
+    if (tree->map) {
+        munmap(tree->map, tree->map_size);
+        free(tree);
+        return;
+    }
+
+    free(tree->line);
+    free(tree->points);
+    for (int d = 0; d < KD_DIM; d++) {
+        free(tree->coords[d]);
+        free(tree->fcoords[d]);
+        free(tree->q32[d]);
+        free(tree->q16[d]);
+    }
+    free(tree);
+}
+
+#endif
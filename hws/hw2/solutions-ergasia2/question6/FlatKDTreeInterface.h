@@ -0,0 +1,117 @@
+/**
+ * @file FlatKDTreeInterface.h
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief kd Tree stored in arrays instead of linked nodes
+*/
+
+#ifndef FLAT_KD_TREE_INTERFACE_H
+#define FLAT_KD_TREE_INTERFACE_H
+
+// for the quantized coordinates
+#include <stdint.h>
+// for size_t
+#include <stddef.h>
+
+#include "PointInterface.h"
+#include "RangeInterface.h"
+#include "kdTreeInterface.h"
+
+// The deepest a tree can be (more than enough for any int number of points)
+#define FLAT_MAX_DEPTH 64
+
+// How the coordinates used by the leaf filter are stored. With anything
+// but FLAT_DOUBLE a range is turned into the same form, rounded so that
+// no point inside it is missed, and only the points too close to its
+// bounds to decide are checked again against the exact point.
+typedef enum flat_storage {
+    FLAT_DOUBLE,    // doubles, exact
+    FLAT_FLOAT,     // floats (float32)
+    FLAT_QUANT32,   // 32-bit integers, relative to the bounding box of the points
+    FLAT_QUANT16    // 16-bit integers, relative to the bounding box of the points
+} FlatStorage;
+
+// The same tree as buildKDTree(), without nodes or pointers.
+//
+// A subtree with at most 'bucket' points is a leaf (bucket = 1 gives
+// exactly the tree of buildKDTree()). Every other subtree is split as in
+// buildKDTree(): ceil(n/2) points on the left.
+//
+// The internal nodes are numbered in preorder and only their lines are
+// stored. For the subtree at internal node i with points [lo, lo + n)
+// and m = ceil(n/2):
+//     left child:  internal node i + 1, points [lo, lo + m)
+//     right child: internal node i + 1 + I(m), points [lo + m, lo + n)
+// where I(m) is the number of internal nodes of the left subtree.
+// The axis of a node comes from its depth (depth % KD_DIM).
+//
+// I(m) only depends on m, and the subtrees at depth d all have
+// floor(n/2^d) or floor(n/2^d) + 1 points, so I() is kept in a table
+// with two entries per depth.
+//
+// The points are copied in the order of the leaves (left to right),
+// so the points of every subtree are next to each other. Their
+// coordinates are also kept in one array per axis, so a leaf can be
+// checked against a range a few points at a time (with AVX2 if the
+// CPU has it). Only the arrays of the tree's FlatStorage are
+// allocated.
+typedef struct flat_kdtree {
+    // number of points
+    int n;
+
+    // most points in a leaf
+    int bucket;
+
+    // line of every internal node, in preorder
+    double * line;
+
+    // the points, in the order of the leaves
+    Point * points;
+
+    // how the arrays below are stored
+    FlatStorage storage;
+
+    // the same coordinates, one array per axis (coords[0] has the x's)
+    double * coords[KD_DIM];
+
+    // or as floats
+    float * fcoords[KD_DIM];
+
+    // or quantized: floor((c - low) * scale), limited to [0, 2^bits - 1]
+    uint32_t * q32[KD_DIM];
+    uint16_t * q16[KD_DIM];
+    double low[KD_DIM];
+    double scale[KD_DIM];
+
+    // the bounding box of the points, the region of the root
+    Range bounds;
+
+    // the file mapping the arrays are in (openFlatKDTree()), NULL if they were allocated
+    void * map;
+    size_t map_size;
+
+    // internal[2 * d + k]: internal nodes of a subtree at depth d with size_lo[d] + k points
+    int size_lo[FLAT_MAX_DEPTH];
+    int internal[2 * FLAT_MAX_DEPTH];
+} FlatKDTree;
+
+FlatKDTree * buildFlatKDTree(Point **, int);
+
+FlatKDTree * buildFlatKDTreeBuckets(Point **, int, int);
+
+FlatKDTree * buildFlatKDTreeStorage(Point **, int, int, FlatStorage);
+
+size_t flatKDTreeMemory(FlatKDTree *);
+
+// A flat tree saved with saveFlatKDTree() is opened by openFlatKDTree()
+// without reading it: the arrays are used straight from the mapping of
+// the file. The file is only valid for the same KD_DIM and byte order.
+int saveFlatKDTree(FlatKDTree *, const char *);
+
+FlatKDTree * openFlatKDTree(const char *);
+
+void searchFlatKDTree(FlatKDTree *, Range *, Range *, PointSink, void *);
+
+void destroyFlatKDTree(FlatKDTree *);
+
+#endif
@@ -69,7 +69,7 @@ void AddFirst(List l, Point * p) {
     // the point already exists in memory and 
     // the list just nedd to have reference to it
     // no need to create a new one point
-    newNode->value = point_init(p->x, p->y);
+    newNode->value = point_init_coords(p->c);
     if (!newNode->value) {
         free(newNode);
         return;
@@ -0,0 +1,521 @@
+/**
+ * @file ParallelBuildImplementation.c
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief kd Tree built by several threads, the same tree as buildKDTree()
+ * @details The top levels, where there are fewer subsets than threads, are split one
+ * subset at a time, with all the threads partitioning it around the median together.
+ * The subsets below them are tasks of a work-stealing pool: every thread keeps a deque
+ * of tasks, splits the subset of a task, pushes the right half as a new task and goes on
+ * with the left half. A thread that runs out of tasks takes the oldest (largest) task of
+ * another thread. Subsets of at most PARALLEL_CUTOFF points are built by one thread
+ * with build_selected(). Points are compared with a total order (point_order()), so every
+ * split has exactly one result and the tree is the one of buildKDTree().
+*/
+
+#ifndef PARALLEL_BUILD_IMPLEMENTATION_C
+#define PARALLEL_BUILD_IMPLEMENTATION_C
+
+// for memory allocation
+#include <stdlib.h>
+// for stderr use
+#include <stdio.h>
+// for memcpy
+#include <string.h>
+// for the threads
+#include <pthread.h>
+// for sched_yield
+#include <sched.h>
+// for the number of pending tasks
+#include <stdatomic.h>
+// all implemented header files in this directory
+#include "kdTreeInterface.h"
+#include "PointInterface.h"
+
+// subsets up to this size are built by one thread without new tasks
+#define PARALLEL_CUTOFF 16384
+
+// subsets at least this large are partitioned by all the threads together
+#define PARALLEL_SELECT_MIN (1 << 20)
+
+// points sampled to find two splitters close to the median
+#define PARALLEL_SAMPLES 65536
+
+// the most tasks in the deque of a thread (one per level of the tree is enough)
+#define PARALLEL_DEQUE 128
+
+// from kdTreeImplementation.c
+int point_order(const Point *, const Point *, int);
+extern PointComparator point_order_qsort[KD_DIM];
+void select_point(Point **, int, int, int);
+KDNode * build_selected(Point **, int, int);
+KDNode * leaf_order(KDNode *);
+
+// a subset whose subtree has to be built and where to attach it
+typedef struct build_task {
+    Point ** points;
+    int n;
+    int depth;
+    KDNode ** slot;
+} BuildTask;
+
+// the tasks of a thread: it pushes and pops at the bottom, the others steal from the top
+typedef struct task_deque {
+    pthread_mutex_t lock;
+    BuildTask tasks[PARALLEL_DEQUE];
+    int top;
+    int bottom;
+} TaskDeque;
+
+// state shared by the threads of one buildKDTreeParallel()
+struct parallel_kd {
+    int threads;
+    TaskDeque * deques;
+
+    // tasks pushed and not finished yet, the threads stop when it is 0
+    atomic_int pending;
+
+    // set if a node could not be allocated
+    atomic_int failed;
+
+    // the subset being partitioned by all the threads (top levels)
+    Point ** points;
+    Point ** scratch;
+    int n;
+    int axis;
+    Point * low;
+    Point * high;
+
+    // per thread: points below low, between low and high, above high
+    int * below;
+    int * between;
+    int * above;
+};
+
+// argument of every thread: the shared state and the thread's number
+struct parallel_kd_task {
+    struct parallel_kd * b;
+    int id;
+};
+
+/* ------------------------------ HELPER FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function that runs a function on every thread and waits for all of them
+ * @param b the shared state
+ * @param work the function, called with a struct parallel_kd_task *
+ * @return -
+*/
+void parallel_kd_run(struct parallel_kd * b, void * (*work)(void *)) {
+    pthread_t workers[b->threads];
+    struct parallel_kd_task tasks[b->threads];
+    int started[b->threads];
+
+    for (int i = 0; i < b->threads; i++) {
+        tasks[i].b = b;
+        tasks[i].id = i;
+    }
+
+    // thread 0 is the caller, the work of a thread that cannot start is done by the caller
+    for (int i = 1; i < b->threads; i++) started[i] = (pthread_create(&workers[i], NULL, work, &tasks[i]) == 0);
+    work(&tasks[0]);
+
+    for (int i = 1; i < b->threads; i++) {
+        if (started[i]) pthread_join(workers[i], NULL);
+        else work(&tasks[i]);
+    }
+}
+
+/**
+ * @brief Function that returns where the slice of a thread starts
+ * @param n the number of points
+ * @param threads the number of threads
+ * @param id the thread
+ * @return the first position of the slice (the slice ends where the one of id + 1 starts)
+*/
+int slice_start(int n, int threads, int id) {
+    return (int)((long long)n * id / threads);
+}
+
+/**
+ * @brief Function run by every thread: counts the points of its slice below, between and above the splitters
+ * @param arg struct parallel_kd_task
+ * @return NULL
+*/
+void * count_work(void * arg) {
+    struct parallel_kd_task * t = (struct parallel_kd_task *)arg;
+    struct parallel_kd * b = t->b;
+    int below = 0, above = 0;
+    int first = slice_start(b->n, b->threads, t->id), last = slice_start(b->n, b->threads, t->id + 1);
+
+    for (int i = first; i < last; i++) {
+        if (point_order(b->points[i], b->low, b->axis) < 0) below++;
+        else if (point_order(b->points[i], b->high, b->axis) > 0) above++;
+    }
+
+    b->below[t->id] = below;
+    b->between[t->id] = (last - first) - below - above;
+    b->above[t->id] = above;
+
+    return NULL;
+}
+
+/**
+ * @brief Function run by every thread: copies the points of its slice to their part of scratch
+ * @details below[], between[] and above[] hold where the thread writes each kind of points
+ * @param arg struct parallel_kd_task
+ * @return NULL
+*/
+void * scatter_work(void * arg) {
+    struct parallel_kd_task * t = (struct parallel_kd_task *)arg;
+    struct parallel_kd * b = t->b;
+    int below = b->below[t->id], between = b->between[t->id], above = b->above[t->id];
+    int first = slice_start(b->n, b->threads, t->id), last = slice_start(b->n, b->threads, t->id + 1);
+
+    for (int i = first; i < last; i++) {
+        Point * p = b->points[i];
+
+        if (point_order(p, b->low, b->axis) < 0) b->scratch[below++] = p;
+        else if (point_order(p, b->high, b->axis) > 0) b->scratch[above++] = p;
+        else b->scratch[between++] = p;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Function run by every thread: copies its slice of scratch back to the points
+ * @param arg struct parallel_kd_task
+ * @return NULL
+*/
+void * copy_work(void * arg) {
+    struct parallel_kd_task * t = (struct parallel_kd_task *)arg;
+    struct parallel_kd * b = t->b;
+    int first = slice_start(b->n, b->threads, t->id), last = slice_start(b->n, b->threads, t->id + 1);
+
+    memcpy(b->points + first, b->scratch + first, (last - first) * sizeof(Point *));
+
+    return NULL;
+}
+
+/**
+ * @brief Function to move the k-th point of an array to position k with all the threads, same result as select_point()
+ * @details two splitters are picked from a sorted sample just below and above the k-th point.
+ * The threads count the points below, between and above them in their slices, then copy
+ * each point to its part of scratch. Only the (small) part between the splitters is left
+ * for select_point(). If the k-th point is not between the splitters, select_point() does it all.
+ * @param b the shared state (threads, and scratch with room for n points)
+ * @param points the array
+ * @param scratch the same number of points as 'points'
+ * @param n the number of points
+ * @param k the position
+ * @param axis the axis to compare on
+ * @return -
+*/
+void parallel_select(struct parallel_kd * b, Point ** points, Point ** scratch, int n, int k, int axis) {
+    int samples = (n < PARALLEL_SAMPLES) ? n : PARALLEL_SAMPLES;
+    Point ** sample = (Point **)malloc(samples * sizeof(Point *));
+
+    if (!sample) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        select_point(points, n, k, axis);
+        return;
+    }
+
+    for (int i = 0; i < samples; i++) sample[i] = points[(long long)i * n / samples];
+
+    qsort(sample, samples, sizeof(Point *), point_order_qsort[axis]);
+
+    // splitters about 4 standard deviations away from the expected place of the k-th point
+    int at = (int)((long long)k * samples / n);
+    int low = (at - 1024 > 0) ? at - 1024 : 0;
+    int high = (at + 1024 < samples - 1) ? at + 1024 : samples - 1;
+
+    b->points = points;
+    b->scratch = scratch;
+    b->n = n;
+    b->axis = axis;
+    b->low = sample[low];
+    b->high = sample[high];
+
+    free(sample);
+
+    parallel_kd_run(b, count_work);
+
+    int below = 0, between = 0;
+
+    for (int i = 0; i < b->threads; i++) {
+        below += b->below[i];
+        between += b->between[i];
+    }
+
+    if (k < below || k >= below + between) {
+        select_point(points, n, k, axis);
+        return;
+    }
+
+    // where every thread starts writing each kind of points
+    int next_below = 0, next_between = below, next_above = below + between;
+
+    for (int i = 0; i < b->threads; i++) {
+        int count;
+
+        count = b->below[i];
+        b->below[i] = next_below;
+        next_below += count;
+
+        count = b->between[i];
+        b->between[i] = next_between;
+        next_between += count;
+
+        count = b->above[i];
+        b->above[i] = next_above;
+        next_above += count;
+    }
+
+    parallel_kd_run(b, scatter_work);
+    parallel_kd_run(b, copy_work);
+
+    select_point(points + below, between, k - below, axis);
+}
+
+/**
+ * @brief Function to add a task to the bottom of the deque of a thread
+ * @param d the deque
+ * @param task the task
+ * @return 0 on success, -1 if the deque is full
+*/
+int deque_push(TaskDeque * d, BuildTask task) {
+    pthread_mutex_lock(&d->lock);
+
+    if (d->bottom == PARALLEL_DEQUE && d->top > 0) {
+        memmove(d->tasks, d->tasks + d->top, (d->bottom - d->top) * sizeof(BuildTask));
+        d->bottom -= d->top;
+        d->top = 0;
+    }
+
+    int pushed = (d->bottom < PARALLEL_DEQUE);
+    if (pushed) d->tasks[d->bottom++] = task;
+
+    pthread_mutex_unlock(&d->lock);
+
+    return pushed ? 0 : -1;
+}
+
+/**
+ * @brief Function to take a task from the deque of a thread
+ * @param d the deque
+ * @param task where to store the task
+ * @param steal 1 to take the oldest task (from the top), 0 for the newest (from the bottom)
+ * @return 1 if a task was taken, 0 if the deque was empty
+*/
+int deque_take(TaskDeque * d, BuildTask * task, int steal) {
+    pthread_mutex_lock(&d->lock);
+
+    int taken = (d->bottom > d->top);
+
+    if (taken) *task = steal ? d->tasks[d->top++] : d->tasks[--d->bottom];
+    if (d->top == d->bottom) d->top = d->bottom = 0;
+
+    pthread_mutex_unlock(&d->lock);
+
+    return taken;
+}
+
+/**
+ * @brief Function to build the subtree of a task, pushing the right halves of large subsets as new tasks
+ * @param b the shared state
+ * @param id the thread
+ * @param task the task
+ * @return -
+*/
+void run_task(struct parallel_kd * b, int id, BuildTask task) {
+    while (task.n > PARALLEL_CUTOFF) {
+        int axis = task.depth % KD_DIM;
+        int med = (task.n + 1) / 2 - 1;
+
+        select_point(task.points, task.n, med, axis);
+
+        KDNode * v = kdnode_init(NULL, task.points[med]->c[axis], (NodeType)axis);
+
+        if (!v) {
+            atomic_store(&b->failed, 1);
+            *task.slot = NULL;
+            return;
+        }
+
+        v->count = task.n;
+        *task.slot = v;
+
+        BuildTask right = { task.points + med + 1, task.n - med - 1, task.depth + 1, &v->right };
+
+        atomic_fetch_add(&b->pending, 1);
+
+        // a full deque means the right half is built here, after the left one
+        if (deque_push(&b->deques[id], right) != 0) {
+            atomic_fetch_sub(&b->pending, 1);
+            run_task(b, id, right);
+        }
+
+        // the left half stays at the same place
+        task.n = med + 1;
+        task.depth = task.depth + 1;
+        task.slot = &v->left;
+    }
+
+    *task.slot = build_selected(task.points, task.n, task.depth);
+    if (!*task.slot) atomic_store(&b->failed, 1);
+}
+
+/**
+ * @brief Function run by every thread: runs its own tasks, then steals from the others, until no task is pending
+ * @param arg struct parallel_kd_task
+ * @return NULL
+*/
+void * steal_work(void * arg) {
+    struct parallel_kd_task * t = (struct parallel_kd_task *)arg;
+    struct parallel_kd * b = t->b;
+    unsigned int seed = 2654435761u * (t->id + 1);
+
+    while (atomic_load(&b->pending) > 0) {
+        BuildTask task;
+        int found = deque_take(&b->deques[t->id], &task, 0);
+
+        // a random victim, then the others in order
+        seed = seed * 1103515245u + 12345u;
+        int victim = (int)((seed >> 16) % b->threads);
+
+        for (int i = 0; !found && i < b->threads; i++) {
+            int other = (victim + i) % b->threads;
+            if (other != t->id) found = deque_take(&b->deques[other], &task, 1);
+        }
+
+        if (!found) {
+            sched_yield();
+            continue;
+        }
+
+        run_task(b, t->id, task);
+        atomic_fetch_sub(&b->pending, 1);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Function to split the top levels one subset at a time with all the threads, leaving tasks for the levels below
+ * @param b the shared state
+ * @param points the points of the subset
+ * @param scratch the same number of points as 'points'
+ * @param n the number of points
+ * @param depth depth of the subset
+ * @param slot where to attach its subtree
+ * @param next the thread that gets the next task
+ * @return -
+*/
+void build_top(struct parallel_kd * b, Point ** points, Point ** scratch, int n, int depth, KDNode ** slot, int * next) {
+    // enough subsets for every thread, or too small to be worth splitting together
+    if ((1 << depth) >= b->threads || n < PARALLEL_SELECT_MIN || n <= PARALLEL_CUTOFF) {
+        BuildTask task = { points, n, depth, slot };
+
+        atomic_fetch_add(&b->pending, 1);
+
+        if (deque_push(&b->deques[*next], task) != 0) {
+            atomic_fetch_sub(&b->pending, 1);
+            run_task(b, 0, task);
+        }
+
+        *next = (*next + 1) % b->threads;
+        return;
+    }
+
+    int axis = depth % KD_DIM;
+    int med = (n + 1) / 2 - 1;
+
+    parallel_select(b, points, scratch, n, med, axis);
+
+    KDNode * v = kdnode_init(NULL, points[med]->c[axis], (NodeType)axis);
+
+    if (!v) {
+        atomic_store(&b->failed, 1);
+        *slot = NULL;
+        return;
+    }
+
+    v->count = n;
+    *slot = v;
+
+    build_top(b, points, scratch, med + 1, depth + 1, &v->left, next);
+    build_top(b, points + med + 1, scratch + med + 1, n - med - 1, depth + 1, &v->right, next);
+}
+
+/* ------------------------------ CORE FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function to build a KDTree with several threads
+ * @details gives the same tree as buildKDTree(). The points must be different Point objects
+ * (they may have the same coordinates).
+ * @param points the set of points, reordered
+ * @param n the number of points in 'points'
+ * @param threads the number of threads (the caller is one of them)
+ * @return A pointer to the KDTree created
+*/
+KDNode * buildKDTreeParallel(Point ** points, int n, int threads) {
+    if (!points || n <= 0) return NULL;
+
+    if (threads < 1) threads = 1;
+
+    struct parallel_kd b;
+    memset(&b, 0, sizeof(b));
+
+    b.threads = threads;
+    atomic_init(&b.pending, 0);
+    atomic_init(&b.failed, 0);
+
+    b.deques = (TaskDeque *)malloc(threads * sizeof(TaskDeque));
+    b.below = (int *)malloc(threads * sizeof(int));
+    b.between = (int *)malloc(threads * sizeof(int));
+    b.above = (int *)malloc(threads * sizeof(int));
+
+    // only needed if the top levels are split together
+    Point ** scratch = (threads > 1 && n >= PARALLEL_SELECT_MIN) ? (Point **)malloc(n * sizeof(Point *)) : NULL;
+
+    if (!b.deques || !b.below || !b.between || !b.above || (threads > 1 && n >= PARALLEL_SELECT_MIN && !scratch)) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(b.deques);
+        free(b.below);
+        free(b.between);
+        free(b.above);
+        free(scratch);
+        return NULL;
+    }
+
+    for (int i = 0; i < threads; i++) {
+        pthread_mutex_init(&b.deques[i].lock, NULL);
+        b.deques[i].top = b.deques[i].bottom = 0;
+    }
+
+    KDNode * root = NULL;
+    int next = 0;
+
+    build_top(&b, points, scratch, n, 0, &root, &next);
+
+    parallel_kd_run(&b, steal_work);
+
+    for (int i = 0; i < threads; i++) pthread_mutex_destroy(&b.deques[i].lock);
+
+    free(b.deques);
+    free(b.below);
+    free(b.between);
+    free(b.above);
+    free(scratch);
+
+    if (atomic_load(&b.failed)) {
+        destroyKDTree(root);
+        return NULL;
+    }
+
+    return leaf_order(root);
+}
+
+#endif
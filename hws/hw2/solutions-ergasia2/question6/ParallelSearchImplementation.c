@@ -0,0 +1,148 @@
+/**
+ * @file ParallelSearchImplementation.c
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief range queries on a read-only kd Tree, answered by several threads at once
+*/
+
+#ifndef PARALLEL_SEARCH_IMPLEMENTATION_C
+#define PARALLEL_SEARCH_IMPLEMENTATION_C
+
+// for memory allocation
+#include <stdlib.h>
+// for stderr use
+#include <stdio.h>
+// for the threads
+#include <pthread.h>
+// for handing out the queries
+#include <stdatomic.h>
+// all implemented header files in this directory
+#include "kdTreeInterface.h"
+#include "PointBufferInterface.h"
+#include "RangeInterface.h"
+
+// queries taken by a thread at once
+#define BATCH_CHUNK 64
+
+// from kdTreeImplementation.c
+int * z_order(Point *, int);
+
+// state shared by the threads of one searchKDTreeBatch()
+struct batch {
+    KDNode * root;
+    Range * ranges;
+    Range * region;
+    PointBuffer ** results;
+    int n;
+
+    // the order the queries are answered in, NULL for the order given
+    int * order;
+
+    // the first query not taken by a thread yet (position in order)
+    atomic_int next;
+
+    // the number of queries whose buffer could not hold every result
+    atomic_int failed;
+};
+
+/* ------------------------------ HELPER FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function run by every thread: takes BATCH_CHUNK queries at a time until none are left
+ * @details the tree is only read and every query writes only its own buffer, so the threads
+ * share nothing but the counters. The search itself needs no memory (the regions are on the stack)
+ * @param arg the struct batch
+ * @return NULL
+*/
+void * batch_work(void * arg) {
+    struct batch * b = (struct batch *)arg;
+
+    for (;;) {
+        int first = atomic_fetch_add(&b->next, BATCH_CHUNK);
+        if (first >= b->n) break;
+
+        int last = (first + BATCH_CHUNK < b->n) ? first + BATCH_CHUNK : b->n;
+
+        for (int i = first; i < last; i++) {
+            int q = b->order ? b->order[i] : i;
+            if (!b->results[q]) continue;
+
+            point_buffer_clear(b->results[q]);
+            searchKDTreeSink(b->root, &b->ranges[q], b->region, point_buffer_add, b->results[q]);
+
+            if (b->results[q]->failed) atomic_fetch_add(&b->failed, 1);
+        }
+    }
+
+    return NULL;
+}
+
+/* ------------------------------ CORE FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function to answer many range queries on the same tree with several threads
+ * @details the tree must not change during the call. The threads take the queries in
+ * chunks, so a slow chunk doesn't hold the others back
+ * @param root The tree’s root
+ * @param ranges The query ranges
+ * @param n The number of queries
+ * @param region The region of the whole tree, it must contain every point (NULL for all of space)
+ * @param results results[i] gets the points inside ranges[i], as in searchKDTreeSink() (it is cleared first, NULL to skip the query)
+ * @param threads The number of threads (the caller is one of them)
+ * @param spatial 1 to answer the queries in Z-order of their centers, so that a thread answers nearby queries one after the other
+ * @return the number of queries that lost points because their buffer could not grow (their failed is set), 0 if none
+*/
+int searchKDTreeBatch(KDNode * root, Range * ranges, int n, Range * region, PointBuffer ** results, int threads, int spatial) {
+    if (!root || !ranges || !results || n <= 0) return 0;
+
+    if (threads < 1) threads = 1;
+
+    struct batch b;
+    b.root = root;
+    b.ranges = ranges;
+    b.region = region;
+    b.results = results;
+    b.n = n;
+    b.order = NULL;
+    atomic_init(&b.next, 0);
+    atomic_init(&b.failed, 0);
+
+    if (spatial) {
+        Point * centers = (Point *)malloc(n * sizeof(Point));
+
+        if (centers) {
+            for (int i = 0; i < n; i++) {
+                centers[i].x = (ranges[i].xmin + ranges[i].xmax) / 2;
+                centers[i].y = (ranges[i].ymin + ranges[i].ymax) / 2;
+            }
+
+            b.order = z_order(centers, n);
+            free(centers);
+        } else {
+            // the queries are still answered, in the order given
+            fprintf(stderr, "Unable to allocate memory.\n");
+        }
+    }
+
+    pthread_t * workers = (threads > 1) ? (pthread_t *)malloc((threads - 1) * sizeof(pthread_t)) : NULL;
+    int started = 0;
+
+    if (threads > 1 && !workers) fprintf(stderr, "Unable to allocate memory.\n");
+
+    // thread 0 is the caller
+    for (int i = 0; workers && i < threads - 1; i++) {
+        if (pthread_create(&workers[i], NULL, batch_work, &b) != 0) break;
+        started++;
+    }
+
+    batch_work(&b);
+
+    for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+
+    free(workers);
+    free(b.order);
+
+    return atomic_load(&b.failed);
+}
+
+#endif
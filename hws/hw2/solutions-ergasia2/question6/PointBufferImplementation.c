@@ -0,0 +1,94 @@
+/**
+ * @file PointBufferImplementation.c
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief Growable array of point references
+*/
+
+#ifndef POINT_BUFFER_IMPLEMENTATION_C
+#define POINT_BUFFER_IMPLEMENTATION_C
+
+// for memory allocation
+#include <stdlib.h>
+// for stderr use
+#include <stdio.h>
+// implemented header files in this directory
+#include "PointBufferInterface.h"
+#include "PointInterface.h"
+
+/**
+ * @brief Function to create a new, empty buffer
+ * @param size how many points fit before the buffer has to grow (at least 1 is used)
+ * @return pointer to the new buffer
+*/
+PointBuffer * point_buffer_init(int size) {
+    PointBuffer * NewBuffer = (PointBuffer *)malloc(sizeof(struct point_buffer));
+
+    if (size < 1) size = 1;
+
+    if (NewBuffer) NewBuffer->points = (Point **)malloc(size * sizeof(Point *));
+
+    if (!NewBuffer || !NewBuffer->points) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(NewBuffer);
+        return NULL;
+    }
+
+    NewBuffer->count = 0;
+    NewBuffer->size = size;
+    NewBuffer->failed = 0;
+
+    return NewBuffer;
+}
+
+/**
+ * @brief Function to append a point reference to a buffer, doubling it when it is full
+ * @details if the buffer cannot grow the point is dropped and failed is set
+ * @param p the point (not copied)
+ * @param buffer the PointBuffer
+ * @return -
+*/
+void point_buffer_add(Point * p, void * buffer) {
+    PointBuffer * b = (PointBuffer *)buffer;
+
+    if (b->count == b->size) {
+        Point ** points = (Point **)realloc(b->points, 2 * b->size * sizeof(Point *));
+
+        if (!points) {
+            if (!b->failed) fprintf(stderr, "Unable to allocate memory.\n");
+            b->failed = 1;
+            return;
+        }
+
+        b->points = points;
+        b->size *= 2;
+    }
+
+    b->points[b->count++] = p;
+}
+
+/**
+ * @brief Function to empty a buffer, keeping its memory for the next query (failed is reset too)
+ * @param b the buffer
+ * @return -
+*/
+void point_buffer_clear(PointBuffer * b) {
+    if (!b) return;
+
+    b->count = 0;
+    b->failed = 0;
+}
+
+/**
+ * @brief Function to free a buffer (but not the points it refers to)
+ * @param b the buffer
+ * @return -
+*/
+void point_buffer_destroy(PointBuffer * b) {
+    if (!b) return;
+
+    free(b->points);
+    free(b);
+}
+
+#endif
@@ -0,0 +1,36 @@
+/**
+ * @file PointBufferInterface.h
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief Interface for a growable array of point references, used to collect the results of kd Tree queries
+*/
+
+#ifndef POINT_BUFFER_INTERFACE_H
+#define POINT_BUFFER_INTERFACE_H
+
+#include "PointInterface.h"
+
+// The buffer only stores pointers to the points (usually the
+// ones in the leaves of a kd Tree), the points are not copied.
+// They stay valid for as long as the tree they came from.
+// failed is set when a point could not be added (the buffer
+// could not grow) and stays set until the buffer is cleared,
+// so a caller checks it once after the whole query.
+typedef struct point_buffer {
+    Point ** points;
+    int count;
+    int size;
+    int failed;
+} PointBuffer;
+
+PointBuffer * point_buffer_init(int);
+
+// has the signature of a PointSink (see kdTreeInterface.h),
+// with the buffer as the context
+void point_buffer_add(Point *, void *);
+
+void point_buffer_clear(PointBuffer *);
+
+void point_buffer_destroy(PointBuffer *);
+
+#endif
@@ -25,9 +25,45 @@ Point * point_init(double x, double y) {
     NewPoint->x = x;
     NewPoint->y = y;
 
+    // the coordinates after y (KD_DIM > 2) start at 0
+    for (int i = 2; i < KD_DIM; i++) NewPoint->c[i] = 0;
+
+    return NewPoint;
+}
+
+/**
+ * @brief Function to initialize a new Point from all of its coordinates
+ * @param coords KD_DIM coordinates
+ * @return pointer to the new Point
+*/
+Point * point_init_coords(const double * coords) {
+    Point * NewPoint = (Point *)malloc(sizeof(struct point));
+    if (!NewPoint) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return NULL;
+    }
+
+#define POINT_COPY(i) NewPoint->c[i] = coords[i];
+    KD_EACH(POINT_COPY)
+#undef POINT_COPY
+
     return NewPoint;
 }
 
+/**
+ * @brief Function to check if two points have the same coordinates
+ * @param a first point
+ * @param b second point
+ * @return 1: same coordinates, 0: different coordinates
+*/
+int point_equal(const Point * a, const Point * b) {
+#define POINT_DIFFERENT(i) if (a->c[i] != b->c[i]) return 0;
+    KD_EACH(POINT_DIFFERENT)
+#undef POINT_DIFFERENT
+
+    return 1;
+}
+
 
 // although said not to implement, had to to check
 // if other functions work correctly
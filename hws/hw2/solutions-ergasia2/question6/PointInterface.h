@@ -8,14 +8,50 @@
 #ifndef POINT_INTERFACE_H
 #define POINT_INTERFACE_H
 
+// Number of coordinates of a point, fixed at compile time
+// (make DIM=3 or -DKD_DIM=3). Everything else follows from it.
+#ifndef KD_DIM
+#define KD_DIM 2
+#endif
+
+#if KD_DIM < 2 || KD_DIM > 8
+#error "KD_DIM must be between 2 and 8"
+#endif
+
+// KD_EACH(F) expands to F(0) F(1) ... F(KD_DIM - 1), so the
+// per-coordinate loops are unrolled by the preprocessor
+#define KD_EACH_1(F) F(0)
+#define KD_EACH_2(F) KD_EACH_1(F) F(1)
+#define KD_EACH_3(F) KD_EACH_2(F) F(2)
+#define KD_EACH_4(F) KD_EACH_3(F) F(3)
+#define KD_EACH_5(F) KD_EACH_4(F) F(4)
+#define KD_EACH_6(F) KD_EACH_5(F) F(5)
+#define KD_EACH_7(F) KD_EACH_6(F) F(6)
+#define KD_EACH_8(F) KD_EACH_7(F) F(7)
+#define KD_EACH_GLUE(n) KD_EACH_##n
+#define KD_EACH_N(n) KD_EACH_GLUE(n)
+#define KD_EACH(F) KD_EACH_N(KD_DIM)(F)
+
+// The first two coordinates keep their names (p->x, p->y),
+// all of them are p->c[0] ... p->c[KD_DIM - 1]
 typedef struct point{
-    double x;
-    double y;
+    union {
+        struct {
+            double x;
+            double y;
+        };
+        double c[KD_DIM];
+    };
 } Point;
    
 //Point functions - Helper functions you will find useful on your implementation
 
 Point * point_init(double, double);
+
+Point * point_init_coords(const double *);
+
+int point_equal(const Point *, const Point *);
+
 // Function type declaration - no need to implement
 // anything for this - simply include it in your code
    
@@ -28,4 +64,4 @@ int point_compare_x(const void *a,const void *b);
 int point_compare_y(const void *a,const void *b);
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,470 @@
+/**
+ * @file PointSetImplementation.c
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief loading the points of a kd Tree from CSV and binary files
+*/
+
+#ifndef POINT_SET_IMPLEMENTATION_C
+#define POINT_SET_IMPLEMENTATION_C
+
+// for memory allocation and strtod()
+#include <stdlib.h>
+// for stdin and stderr use
+#include <stdio.h>
+// for memchr(), memcpy() and the file names
+#include <string.h>
+// for isfinite()
+#include <math.h>
+// for INT_MAX
+#include <limits.h>
+// for uint64_t
+#include <stdint.h>
+// for mapping the files
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+// all implemented header files in this directory
+#include "PointSetInterface.h"
+#include "PointInterface.h"
+#include "RangeInterface.h"
+
+// first size of the buffer a file is read into
+#define READ_CHUNK (1 << 16)
+
+// first number of points of a CSV file, doubled when it fills up
+#define SET_CAPACITY 1024
+
+// longest number handed to strtod()
+#define NUMBER_MAX 64
+
+// The contents of a file: mapped (map) or read into a buffer (buffer)
+struct file_bytes {
+    const char * bytes;
+    size_t size;
+
+    void * map;
+    char * buffer;
+};
+
+// 10^0 ... 10^22, all exact as doubles
+static const double powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* ------------------------------ HELPER FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function to read a whole file into memory, by mapping it or into a buffer
+ * @param path The file ("-" for stdin, which is always read)
+ * @param use_mmap 1 to map the file
+ * @param file Gets the contents, give it to file_bytes_close() afterwards
+ * @return 1 on success, 0 on failure
+*/
+int file_bytes_open(const char * path, int use_mmap, struct file_bytes * file) {
+    memset(file, 0, sizeof(*file));
+
+    int from_stdin = strcmp(path, "-") == 0;
+
+    if (use_mmap && !from_stdin) {
+        int fd = open(path, O_RDONLY);
+        struct stat info;
+
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            fprintf(stderr, "Unable to open %s.\n", path);
+            if (fd >= 0) close(fd);
+            return 0;
+        }
+
+        // an empty file can't be mapped, and has no points anyway
+        if (info.st_size > 0) {
+            void * map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (map == MAP_FAILED) {
+                fprintf(stderr, "Unable to open %s.\n", path);
+                close(fd);
+                return 0;
+            }
+
+            // the file is parsed once, front to back
+            madvise(map, info.st_size, MADV_SEQUENTIAL);
+
+            file->map = map;
+            file->bytes = (const char *)map;
+            file->size = info.st_size;
+        }
+
+        close(fd);
+        return 1;
+    }
+
+    FILE * stream = from_stdin ? stdin : fopen(path, "rb");
+
+    if (!stream) {
+        fprintf(stderr, "Unable to open %s.\n", path);
+        return 0;
+    }
+
+    size_t capacity = READ_CHUNK, size = 0;
+    char * buffer = (char *)malloc(capacity);
+    int ok = buffer != NULL;
+
+    if (!ok) fprintf(stderr, "Unable to allocate memory.\n");
+
+    while (ok) {
+        if (size == capacity) {
+            char * bigger = (char *)realloc(buffer, 2 * capacity);
+
+            if (!bigger) {
+                fprintf(stderr, "Unable to allocate memory.\n");
+                ok = 0;
+                break;
+            }
+
+            buffer = bigger;
+            capacity *= 2;
+        }
+
+        size_t got = fread(buffer + size, 1, capacity - size, stream);
+        size += got;
+
+        if (got == 0) break;
+    }
+
+    if (ok && ferror(stream)) {
+        fprintf(stderr, "Unable to read %s.\n", path);
+        ok = 0;
+    }
+
+    if (!from_stdin) fclose(stream);
+
+    if (!ok) {
+        free(buffer);
+        return 0;
+    }
+
+    file->buffer = buffer;
+    file->bytes = buffer;
+    file->size = size;
+
+    return 1;
+}
+
+/**
+ * @brief Function to release the contents of a file read by file_bytes_open()
+ * @param file The contents
+ * @return -
+*/
+void file_bytes_close(struct file_bytes * file) {
+    if (file->map) munmap(file->map, file->size);
+    free(file->buffer);
+}
+
+/**
+ * @brief Function to parse a decimal number ([sign] digits [. digits] [e [sign] digits])
+ * @details the digits are gathered in an integer. With at most 15 significant digits and a
+ * power of ten up to 22 both are exact doubles, so one multiplication or division gives the
+ * correctly rounded value (the same as strtod()). Anything else, which is rare in point files,
+ * is handed to strtod()
+ * @param p The first character of the number
+ * @param end The end of the text (the number doesn't need a '\0' after it)
+ * @param value Gets the number
+ * @return the character after the number, NULL if there is no finite number at p
+*/
+const char * parse_double(const char * p, const char * end, double * value) {
+    const char * start = p;
+    int negative = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    uint64_t digits = 0;
+    int significant = 0, exponent = 0, seen = 0;
+
+    // 19 digits always fit in 64 bits, the rest only move the decimal point
+    for (; p < end && *p >= '0' && *p <= '9'; p++, seen = 1) {
+        if (significant < 19) {
+            digits = 10 * digits + (*p - '0');
+            if (digits) significant++;
+        } else {
+            exponent++;
+        }
+    }
+
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, seen = 1) {
+            if (significant < 19) {
+                digits = 10 * digits + (*p - '0');
+                if (digits) significant++;
+                exponent--;
+            }
+        }
+    }
+
+    if (!seen) return NULL;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char * q = p + 1;
+        int sign = 1, power = 0;
+
+        if (q < end && (*q == '-' || *q == '+')) {
+            sign = (*q == '-') ? -1 : 1;
+            q++;
+        }
+
+        if (q == end || *q < '0' || *q > '9') return NULL;
+
+        // anything past 10^9999 is infinite or zero anyway
+        for (; q < end && *q >= '0' && *q <= '9'; q++)
+            if (power < 10000) power = 10 * power + (*q - '0');
+
+        exponent += sign * power;
+        p = q;
+    }
+
+    if (significant <= 15 && exponent >= -22 && exponent <= 22) {
+        double v = (double)digits;
+        v = (exponent < 0) ? v / powers_of_ten[-exponent] : v * powers_of_ten[exponent];
+
+        *value = negative ? -v : v;
+        return p;
+    }
+
+    // the slow way, on a copy that ends with '\0'
+    char number[NUMBER_MAX];
+    size_t length = p - start;
+
+    if (length >= NUMBER_MAX) return NULL;
+
+    memcpy(number, start, length);
+    number[length] = '\0';
+
+    *value = strtod(number, NULL);
+
+    return isfinite(*value) ? p : NULL;
+}
+
+/**
+ * @brief Function to skip the characters between the numbers of a CSV line
+ * @param p The first character
+ * @param end The end of the line
+ * @return the first character that is not a separator (or end)
+*/
+const char * skip_separators(const char * p, const char * end) {
+    while (p < end && (*p == ',' || *p == ';' || *p == ' ' || *p == '\t' || *p == '\r')) p++;
+
+    return p;
+}
+
+/**
+ * @brief Function to create an empty point set with room for some points
+ * @param capacity The number of points
+ * @return pointer to the new PointSet
+*/
+PointSet * point_set_create(size_t capacity) {
+    PointSet * set = (PointSet *)calloc(1, sizeof(PointSet));
+
+    if (set) set->data = (Point *)malloc((capacity > 0 ? capacity : 1) * sizeof(Point));
+
+    if (!set || !set->data) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(set);
+        return NULL;
+    }
+
+    return set;
+}
+
+/**
+ * @brief Function to finish a point set once its points are in data: the pointers and the bounding box
+ * @param set The set (destroyed on failure)
+ * @return the set, NULL on failure
+*/
+PointSet * point_set_finish(PointSet * set) {
+    set->points = (Point **)malloc((set->n > 0 ? set->n : 1) * sizeof(Point *));
+
+    if (!set->points) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        point_set_destroy(set);
+        return NULL;
+    }
+
+    for (int i = 0; i < set->n; i++) set->points[i] = &set->data[i];
+
+    set->bounds = range_bounding(set->points, set->n);
+
+    return set;
+}
+
+/* ------------------------------ CORE FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function to load points from a CSV file (see PointSetInterface.h for the format)
+ * @param path The file ("-" for stdin)
+ * @param use_mmap 1 to map the file instead of reading it
+ * @return pointer to the new PointSet, NULL if the file can't be read or has a line that is not a point
+*/
+PointSet * point_set_load_csv(const char * path, int use_mmap) {
+    if (!path) return NULL;
+
+    struct file_bytes file;
+    if (!file_bytes_open(path, use_mmap, &file)) return NULL;
+
+    size_t capacity = SET_CAPACITY;
+    PointSet * set = point_set_create(capacity);
+
+    if (!set) {
+        file_bytes_close(&file);
+        return NULL;
+    }
+
+    const char * p = file.bytes, * end = file.bytes + file.size;
+    int line = 0, header = 1, ok = 1;
+
+    while (ok && p < end) {
+        const char * eol = (const char *)memchr(p, '\n', end - p);
+        if (!eol) eol = end;
+        line++;
+
+        const char * q = skip_separators(p, eol);
+        p = (eol < end) ? eol + 1 : end;
+
+        if (q == eol || *q == '#') continue;
+
+        double c[KD_DIM];
+        int k = 0;
+
+        for (; k < KD_DIM && q; k++) {
+            const char * next = parse_double(q, eol, &c[k]);
+
+            // the numbers have to be separated, or end the line
+            q = next ? skip_separators(next, eol) : NULL;
+            if (q && q == next && q < eol) q = NULL;
+        }
+
+        if (!q || k < KD_DIM || q != eol) {
+            // the first line may name the columns
+            if (header) {
+                header = 0;
+                continue;
+            }
+
+            fprintf(stderr, "%s:%d: not a point of %d coordinates.\n", path, line, KD_DIM);
+            ok = 0;
+            break;
+        }
+
+        header = 0;
+
+        if ((size_t)set->n == capacity) {
+            Point * bigger = (capacity < INT_MAX / 2) ? (Point *)realloc(set->data, 2 * capacity * sizeof(Point)) : NULL;
+
+            if (!bigger) {
+                fprintf(stderr, "Unable to allocate memory.\n");
+                ok = 0;
+                break;
+            }
+
+            set->data = bigger;
+            capacity *= 2;
+        }
+
+        Point * point = &set->data[set->n++];
+
+#define SET_COORD(i) point->c[i] = c[i];
+        KD_EACH(SET_COORD)
+#undef SET_COORD
+    }
+
+    file_bytes_close(&file);
+
+    if (!ok) {
+        point_set_destroy(set);
+        return NULL;
+    }
+
+    return point_set_finish(set);
+}
+
+/**
+ * @brief Function to load points from a binary file (see PointSetInterface.h for the format)
+ * @param path The file ("-" for stdin)
+ * @param use_mmap 1 to map the file instead of reading it
+ * @return pointer to the new PointSet, NULL if the file can't be read, its size is not a
+ * multiple of a point or it has a coordinate that is not a finite number
+*/
+PointSet * point_set_load_binary(const char * path, int use_mmap) {
+    if (!path) return NULL;
+
+    struct file_bytes file;
+    if (!file_bytes_open(path, use_mmap, &file)) return NULL;
+
+    size_t record = KD_DIM * sizeof(double);
+
+    if (file.size % record != 0 || file.size / record > INT_MAX) {
+        fprintf(stderr, "%s is not a binary file of points with %d coordinates.\n", path, KD_DIM);
+        file_bytes_close(&file);
+        return NULL;
+    }
+
+    size_t n = file.size / record;
+    PointSet * set = point_set_create(n);
+
+    if (!set) {
+        file_bytes_close(&file);
+        return NULL;
+    }
+
+    // a Point is exactly KD_DIM doubles, so the file is already a Point array
+    if (n > 0) memcpy(set->data, file.bytes, file.size);
+    set->n = (int)n;
+
+    file_bytes_close(&file);
+
+    for (int i = 0; i < set->n; i++) {
+        for (int d = 0; d < KD_DIM; d++) {
+            if (!isfinite(set->data[i].c[d])) {
+                fprintf(stderr, "%s: point %d has a coordinate that is not a number.\n", path, i);
+                point_set_destroy(set);
+                return NULL;
+            }
+        }
+    }
+
+    return point_set_finish(set);
+}
+
+/**
+ * @brief Function to load points from a file, binary if its name ends in ".bin" and CSV otherwise
+ * @param path The file ("-" for stdin, as CSV)
+ * @param use_mmap 1 to map the file instead of reading it
+ * @return pointer to the new PointSet, NULL on failure
+*/
+PointSet * point_set_load(const char * path, int use_mmap) {
+    if (!path) return NULL;
+
+    size_t length = strlen(path);
+
+    if (length >= 4 && strcmp(path + length - 4, ".bin") == 0) return point_set_load_binary(path, use_mmap);
+
+    return point_set_load_csv(path, use_mmap);
+}
+
+/**
+ * @brief Function to free a point set
+ * @param set The set
+ * @return -
+*/
+void point_set_destroy(PointSet * set) {
+    if (!set) return;
+
+    free(set->points);
+    free(set->data);
+    free(set);
+}
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * @file PointSetInterface.h
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief Interface for loading the points of a kd Tree from a file (PointSetImplementation.c)
+*/
+
+#ifndef POINT_SET_INTERFACE_H
+#define POINT_SET_INTERFACE_H
+
+#include "PointInterface.h"
+#include "RangeInterface.h"
+
+// Points loaded from a file, ready for any of the builders.
+//
+// Two file formats are read:
+//     CSV:    one point per line, KD_DIM numbers separated by commas,
+//             semicolons, spaces or tabs. Empty lines and lines starting
+//             with '#' are skipped, and so is a first line that is not
+//             a point (a header).
+//     binary: KD_DIM doubles per point in the byte order of the machine,
+//             nothing else (no header), the layout of a Point array.
+//
+// The points are in one array (data), points[i] is &data[i].
+typedef struct point_set {
+    // number of points
+    int n;
+
+    // the points
+    Point * data;
+
+    // pointers to them, what buildKDTree() and the other builders take
+    Point ** points;
+
+    // the bounding box of the points, the region of the root of their tree
+    Range bounds;
+} PointSet;
+
+// With use_mmap the file is mapped instead of read into a buffer.
+// A path of "-" reads stdin (never mapped).
+
+PointSet * point_set_load_csv(const char *, int);
+
+PointSet * point_set_load_binary(const char *, int);
+
+// binary if the path ends in ".bin", CSV otherwise
+PointSet * point_set_load(const char *, int);
+
+void point_set_destroy(PointSet *);
+
+#endif
@@ -12,6 +12,8 @@
 #include <stdlib.h>
 // for stdout and stderr use
 #include <stdio.h>
+// for INFINITY
+#include <math.h>
 // all implemented header files in this directory
 #include "RangeInterface.h"
 #include "PointInterface.h"
@@ -39,9 +41,98 @@ Range * range_init(double xmin,double xmax,double ymin,double ymax) {
     NewRange->ymin = ymin;
     NewRange->ymax = ymax;
 
+    // the coordinates after y (KD_DIM > 2) cover the whole plane
+    for (int i = 2; i < KD_DIM; i++) {
+        NewRange->b[i][0] = PLANE_MIN;
+        NewRange->b[i][1] = PLANE_MAX;
+    }
+
     return NewRange;
 }
 
+/**
+ * @brief Function to initialize a new Range on all of its coordinates
+ * @param min the KD_DIM lower bounds
+ * @param max the KD_DIM upper bounds
+ * @return pointer to the new Range
+*/
+Range * range_init_bounds(const double * min, const double * max) {
+    Range * NewRange = (Range *)malloc(sizeof(struct range));
+
+    if (!NewRange) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return NULL;
+    }
+
+#define RANGE_COPY(i) NewRange->b[i][0] = min[i]; NewRange->b[i][1] = max[i];
+    KD_EACH(RANGE_COPY)
+#undef RANGE_COPY
+
+    return NewRange;
+}
+
+/**
+ * @brief Function to get the whole plane (the region of the root of a kd Tree)
+ * @return the plane, by value
+*/
+Range range_plane(void) {
+    Range r;
+
+    r.xmin = PLANE_X_MIN;
+    r.xmax = PLANE_X_MAX;
+    r.ymin = PLANE_Y_MIN;
+    r.ymax = PLANE_Y_MAX;
+
+    for (int i = 2; i < KD_DIM; i++) {
+        r.b[i][0] = PLANE_MIN;
+        r.b[i][1] = PLANE_MAX;
+    }
+
+    return r;
+}
+
+/**
+ * @brief Function to get all of space, the region of the root of a kd Tree whose points can be anywhere
+ * @return a range from -INFINITY to INFINITY on every axis, by value
+*/
+Range range_infinite(void) {
+    Range r;
+
+    for (int i = 0; i < KD_DIM; i++) {
+        r.b[i][0] = -INFINITY;
+        r.b[i][1] = INFINITY;
+    }
+
+    return r;
+}
+
+/**
+ * @brief Function to get the bounding box of some points (the smallest region of a kd Tree
+ * built from them), so the plane doesn't have to be known in advance
+ * @param points The points
+ * @param n The number of points
+ * @return the bounding box, by value (the plane if there are no points)
+*/
+Range range_bounding(Point ** points, int n) {
+    if (!points || n <= 0) return range_plane();
+
+    Range r;
+
+#define BOUND_FIRST(i) r.b[i][0] = r.b[i][1] = points[0]->c[i];
+    KD_EACH(BOUND_FIRST)
+#undef BOUND_FIRST
+
+    for (int k = 1; k < n; k++) {
+        const Point * p = points[k];
+
+#define BOUND_GROW(i) if (p->c[i] < r.b[i][0]) r.b[i][0] = p->c[i]; if (p->c[i] > r.b[i][1]) r.b[i][1] = p->c[i];
+        KD_EACH(BOUND_GROW)
+#undef BOUND_GROW
+    }
+
+    return r;
+}
+
 /**
  * @brief Function to check if a point p is
  * @param p Point to check if inside the range (square)
@@ -51,7 +142,9 @@ Range * range_init(double xmin,double xmax,double ymin,double ymax) {
 int point_in_range(Point * p, Range * R) {
     // return the result of this statement, which 
     // set all the prerequisites for p to b inside R
-    return ( (p->x >= R->xmin) && (p->x <= R->xmax) && (p->y >= R->ymin) && (p->y <= R->ymax) );
+#define IN_RANGE(i) && (p->c[i] >= R->b[i][0]) && (p->c[i] <= R->b[i][1])
+    return ( 1 KD_EACH(IN_RANGE) );
+#undef IN_RANGE
 }
 
 /**
@@ -61,7 +154,9 @@ int point_in_range(Point * p, Range * R) {
  * @return 1: if the two squares intersect, 0: if they don't intersect
 */
 int range_intersect(Range * r1, Range * r2) {
-    return !(r1->xmax < r2->xmin || r1->xmin > r2->xmax || r1->ymax < r2->ymin || r1->ymin > r2->ymax);
+#define APART(i) || r1->b[i][1] < r2->b[i][0] || r1->b[i][0] > r2->b[i][1]
+    return !(0 KD_EACH(APART));
+#undef APART
 }
 
 
@@ -86,10 +181,7 @@ Range * intersect_square_on_x_left(Range * square, double x) {
     }
 
     // set the new range's values
-    NewRange->xmin = square->xmin;
-    NewRange->xmax = x;
-    NewRange->ymin = square->ymin;
-    NewRange->ymax = square->ymax;
+    *NewRange = region_on_x_left(square, x);
 
     return NewRange;
 }
@@ -111,10 +203,7 @@ Range * intersect_square_on_x_right(Range * square, double x) {
     }
 
     // set the new range's values
-    NewRange->xmin = x;
-    NewRange->xmax = square->xmax;
-    NewRange->ymin = square->ymin;
-    NewRange->ymax = square->ymax;
+    *NewRange = region_on_x_right(square, x);
 
     return NewRange;
 }
@@ -136,10 +225,7 @@ Range * intersect_square_on_y_up(Range * square, double y) {
     }
 
     // set the new range's values
-    NewRange->xmin = square->xmin;
-    NewRange->xmax = square->xmax;
-    NewRange->ymin = y;
-    NewRange->ymax = square->ymax;
+    *NewRange = region_on_y_up(square, y);
 
     return NewRange;
 }
@@ -161,14 +247,89 @@ Range * intersect_square_on_y_down(Range * square, double y) {
     }
 
     // set the new range's values
-    NewRange->xmin = square->xmin;
-    NewRange->xmax = square->xmax;
-    NewRange->ymin = square->ymin;
-    NewRange->ymax = y;
+    *NewRange = region_on_y_down(square, y);
 
     return NewRange;
 }
 
+/**
+ * @brief Function to compute the region of the left child of a vertical line
+ * @details same as intersect_square_on_x_left(), but the region is returned by value
+ * so searchKDTree() can keep it on the stack instead of allocating it
+ * @param square the region of the node
+ * @param x the x coordinate of the line
+ * @return the part of square left of x
+*/
+Range region_on_x_left(const Range * square, double x) {
+    return region_below(square, 0, x);
+}
+
+/**
+ * @brief Function to compute the region of the right child of a vertical line
+ * @param square the region of the node
+ * @param x the x coordinate of the line
+ * @return the part of square right of x
+*/
+Range region_on_x_right(const Range * square, double x) {
+    return region_above(square, 0, x);
+}
+
+/**
+ * @brief Function to compute the region of the right child of a horizontal line
+ * @param square the region of the node
+ * @param y the y coordinate of the line
+ * @return the part of square above y
+*/
+Range region_on_y_up(const Range * square, double y) {
+    return region_above(square, 1, y);
+}
+
+/**
+ * @brief Function to compute the region of the left child of a horizontal line
+ * @param square the region of the node
+ * @param y the y coordinate of the line
+ * @return the part of square below y
+*/
+Range region_on_y_down(const Range * square, double y) {
+    return region_below(square, 1, y);
+}
+
+/**
+ * @brief Function to compute the region of the left child of a line on any axis
+ * @param square the region of the node
+ * @param axis the axis of the line (the type of the node)
+ * @param line the coordinate of the line
+ * @return the part of square up to the line
+*/
+Range region_below(const Range * square, int axis, double line) {
+    Range r;
+
+    // every bound is written once (no copy then overwrite), so the
+    // caller can read the new region right away
+#define BELOW_ON(i) r.b[i][0] = square->b[i][0]; r.b[i][1] = (i == axis) ? line : square->b[i][1];
+    KD_EACH(BELOW_ON)
+#undef BELOW_ON
+
+    return r;
+}
+
+/**
+ * @brief Function to compute the region of the right child of a line on any axis
+ * @param square the region of the node
+ * @param axis the axis of the line (the type of the node)
+ * @param line the coordinate of the line
+ * @return the part of square from the line on
+*/
+Range region_above(const Range * square, int axis, double line) {
+    Range r;
+
+#define ABOVE_ON(i) r.b[i][0] = (i == axis) ? line : square->b[i][0]; r.b[i][1] = square->b[i][1];
+    KD_EACH(ABOVE_ON)
+#undef ABOVE_ON
+
+    return r;
+}
+
 /**
  * @brief Function to check if square 'outer' completely contains square 'inner'
  * @param outer the 'outer' square
@@ -179,7 +340,47 @@ int range_contains(Range * outer, Range * inner) {
     // return the result of this statement, which 
     // set all the prerequisites for 'outer' to 
     // completely contain 'inner'
-    return ( (inner->xmin > outer->xmin) && (inner->xmax <= outer->xmax) && (inner->ymin > outer->ymin) && (inner->ymax <= outer->ymax) );
+#define CONTAINS(i) && (inner->b[i][0] > outer->b[i][0]) && (inner->b[i][1] <= outer->b[i][1])
+    return ( 1 KD_EACH(CONTAINS) );
+#undef CONTAINS
+}
+
+/**
+ * @brief Function to compute the squared distance from a point to the closest point of a range
+ * @param r the range
+ * @param p the point
+ * @return the squared distance, 0 if p is inside r
+*/
+double range_min_distance(Range * r, Point * p) {
+    double sum = 0;
+
+#define MIN_DISTANCE(i) { \
+        double d = (p->c[i] < r->b[i][0]) ? r->b[i][0] - p->c[i] : (p->c[i] > r->b[i][1]) ? p->c[i] - r->b[i][1] : 0; \
+        sum += d * d; \
+    }
+    KD_EACH(MIN_DISTANCE)
+#undef MIN_DISTANCE
+
+    return sum;
+}
+
+/**
+ * @brief Function to compute the squared distance from a point to the farthest corner of a range
+ * @param r the range
+ * @param p the point
+ * @return the squared distance
+*/
+double range_max_distance(Range * r, Point * p) {
+    double sum = 0;
+
+#define MAX_DISTANCE(i) { \
+        double d = (p->c[i] - r->b[i][0] > r->b[i][1] - p->c[i]) ? p->c[i] - r->b[i][0] : r->b[i][1] - p->c[i]; \
+        sum += d * d; \
+    }
+    KD_EACH(MAX_DISTANCE)
+#undef MAX_DISTANCE
+
+    return sum;
 }
 
 /**
@@ -195,6 +396,9 @@ void print_range(Range * r) {
     printf(" upper right: (%lf, %lf)\n", r->xmax, r->ymax);
     printf(" lower right: (%lf, %lf)\n", r->xmax, r->ymin);
 
+    // the coordinates after y (KD_DIM > 2)
+    for (int i = 2; i < KD_DIM; i++) printf(" coordinate %d: [%lf, %lf]\n", i, r->b[i][0], r->b[i][1]);
+
     return;
 }
 #endif
\ No newline at end of file
@@ -16,18 +16,39 @@
 #define PLANE_X_MAX 15.000000
 #define PLANE_Y_MIN 0.000000
 #define PLANE_Y_MAX 15.000000
+// same for the coordinates after y (KD_DIM > 2)
+#define PLANE_MIN 0.000000
+#define PLANE_MAX 15.000000
 
 // Using only four variables we can easily
 // represent a square of the form:
 // [(xmin,ymin),(xmax,ymin),(xmin,ymax),(xmax,ymax)]
+// With more coordinates it is a box: b[i][0] and b[i][1]
+// are the bounds on coordinate i (b[0] is xmin, xmax)
 typedef struct range {
-    double xmin, xmax;
-    double ymin, ymax;
+    union {
+        struct {
+            double xmin, xmax;
+            double ymin, ymax;
+        };
+        double b[KD_DIM][2];
+    };
 } Range;
 
 
 Range * range_init(double, double, double, double);
 
+Range * range_init_bounds(const double *, const double *);
+
+Range range_plane(void);
+
+// All of space, the region used by the searches when they are given NULL
+Range range_infinite(void);
+
+// The bounding box of some points, the region of the root of a
+// kd Tree built from them (the plane if there are none)
+Range range_bounding(Point **, int);
+
 int point_in_range(Point *, Range *);
 
 int range_intersect(Range *, Range *);
@@ -41,8 +62,28 @@ Range * intersect_square_on_x_right(Range *, double);
 Range * intersect_square_on_y_up(Range *, double);
 Range * intersect_square_on_y_down(Range *, double);
 
+// The same four functions, but the new region is returned
+// by value, so it can live on the stack (no malloc)
+
+Range region_on_x_left(const Range *, double);
+Range region_on_x_right(const Range *, double);
+Range region_on_y_up(const Range *, double);
+Range region_on_y_down(const Range *, double);
+
+// The same for a line on any axis (the type of a kd Tree node):
+// below is the left child, above the right child
+
+Range region_below(const Range *, int, double);
+Range region_above(const Range *, int, double);
+
 int range_contains(Range *, Range *);
 
+// Squared distances from a point to the closest and to
+// the farthest point of a range (for circle queries)
+
+double range_min_distance(Range *, Point *);
+double range_max_distance(Range *, Point *);
+
 void print_range(Range *);
 
 #endif   
\ No newline at end of file
@@ -0,0 +1,390 @@
+/**
+ * @file RangeTreeImplementation.c
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief a 2-d layered range tree with fractional cascading, range queries in O(log n + k)
+*/
+
+#ifndef RANGE_TREE_IMPLEMENTATION_C
+#define RANGE_TREE_IMPLEMENTATION_C
+
+// for memory allocation
+#include <stdlib.h>
+// for stderr use
+#include <stdio.h>
+// all implemented header files in this directory
+#include "RangeTreeInterface.h"
+#include "kdTreeInterface.h"
+#include "PointInterface.h"
+#include "RangeInterface.h"
+
+// from kdTreeImplementation.c
+extern PointComparator point_order_qsort[KD_DIM];
+
+// a point of the root's list, while it is sorted by y
+struct y_entry {
+    double y;
+    int i;
+};
+
+/* ------------------------------ HELPER FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function to compare two entries of the root's list on y, then on their position (to be used with qsort())
+ * @param a first entry
+ * @param b second entry
+ * @return -1: a comes first, 1: b comes first, 0: the same entry
+*/
+int y_entry_compare(const void * a, const void * b) {
+    const struct y_entry * p = (const struct y_entry *)a;
+    const struct y_entry * q = (const struct y_entry *)b;
+
+    if (p->y != q->y) return (p->y < q->y) ? -1 : 1;
+
+    return (p->i > q->i) - (p->i < q->i);
+}
+
+/**
+ * @brief Function that returns the number of levels with lists of a tree
+ * @param n the number of points
+ * @param bucket the most points in a leaf
+ * @return the levels, down to the deepest leaf
+*/
+int range_tree_levels(int n, int bucket) {
+    int levels = 1;
+
+    // the largest node of every level has ceil(n / 2^level) points
+    for (int size = n; size > bucket; size = size - size / 2) levels++;
+
+    return levels;
+}
+
+/**
+ * @brief Function that splits the list of a node between its children, keeping the order of y
+ * @details a stable partition, so the lists of the children are sorted by y too and the whole
+ * tree is built in O(n log n) without sorting again. It fills left[] on the way
+ * @param tree The tree, with the list of the node filled
+ * @param level The level of the node
+ * @param lo The first point of the node
+ * @param hi One after the last point of the node
+ * @return -
+*/
+void build_range_level(RangeTree * tree, int level, int lo, int hi) {
+    if (hi - lo <= tree->bucket) return;
+
+    int mid = lo + (hi - lo + 1) / 2;
+    int * list = tree->index[level];
+    int * left = tree->left[level];
+    int * below = tree->index[level + 1];
+    int count = 0;
+
+    for (int r = 0; r < hi - lo; r++) {
+        int i = list[lo + r];
+        left[lo + r] = count;
+
+        if (i < mid) below[lo + count++] = i;
+        else below[mid + (r - count)] = i;
+    }
+
+    build_range_level(tree, level + 1, lo, mid);
+    build_range_level(tree, level + 1, mid, hi);
+}
+
+/**
+ * @brief Function that returns the rank in the left child of a rank in a node (the cascading step)
+ * @param tree The tree
+ * @param level The level of the node
+ * @param lo The first point of the node
+ * @param hi One after the last point of the node
+ * @param r The rank in the node's list (0 ... hi - lo)
+ * @return how many of the first r entries of the list are in the left child
+*/
+int rank_left(RangeTree * tree, int level, int lo, int hi, int r) {
+    // past the end all of the left child's points are counted
+    return (r == hi - lo) ? (hi - lo + 1) / 2 : tree->left[level][lo + r];
+}
+
+/**
+ * @brief Function that returns the rank of the first y not below a bound in the list of the root
+ * @param tree The tree
+ * @param bound The bound (ymin or ymax of a range)
+ * @param strict 1 for the first y above the bound instead (for ymax)
+ * @return the rank (n if there is none)
+*/
+int rank_y(RangeTree * tree, double bound, int strict) {
+    int lo = 0, hi = tree->n;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+
+        if (tree->y[mid] < bound || (strict && tree->y[mid] == bound)) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return lo;
+}
+
+/**
+ * @brief Function that returns the position of the first x not below a bound in the points of the tree
+ * @param tree The tree
+ * @param bound The bound (xmin or xmax of a range)
+ * @param strict 1 for the first x above the bound instead (for xmax)
+ * @return the position (n if there is none)
+*/
+int rank_x(RangeTree * tree, double bound, int strict) {
+    int lo = 0, hi = tree->n;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+
+        if (tree->points[mid].x < bound || (strict && tree->points[mid].x == bound)) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return lo;
+}
+
+/**
+ * @brief Recursive function that reports the points of a node inside a range
+ * @details the points with x inside the range are the positions [x_lo, x_hi) (found once, at the root),
+ * and the points of the node with y inside the range are the entries [r_lo, r_hi) of its list.
+ * So a node inside the range on x reports those entries straight away, a node outside is skipped,
+ * and only the nodes on the two paths to x_lo and x_hi go further down. No point is read but the ones reported
+ * @param tree The tree
+ * @param range The query range
+ * @param x_lo The first point with x inside the range
+ * @param x_hi One after the last point with x inside the range
+ * @param level The level of the node
+ * @param lo The first point of the node
+ * @param hi One after the last point of the node
+ * @param r_lo The rank of range->ymin in the node's list
+ * @param r_hi The rank of range->ymax in the node's list (one after the last y inside)
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return -
+*/
+void search_range_tree(RangeTree * tree, Range * range, int x_lo, int x_hi, int level, int lo, int hi, int r_lo, int r_hi, PointSink sink, void * context) {
+    if (r_lo >= r_hi || hi <= x_lo || lo >= x_hi) return;
+
+    int * list = tree->index[level];
+    int inside = (lo >= x_lo && hi <= x_hi);
+
+    if (inside || hi - lo <= tree->bucket) {
+        // on a leaf only the entries with x inside are reported
+        for (int r = r_lo; r < r_hi; r++) {
+            int i = list[lo + r];
+            if (!inside && (i < x_lo || i >= x_hi)) continue;
+#if KD_DIM > 2
+            if (!point_in_range(&tree->points[i], range)) continue;
+#endif
+            sink(&tree->points[i], context);
+        }
+
+        return;
+    }
+
+    int mid = lo + (hi - lo + 1) / 2;
+    int left_lo = rank_left(tree, level, lo, hi, r_lo);
+    int left_hi = rank_left(tree, level, lo, hi, r_hi);
+
+    search_range_tree(tree, range, x_lo, x_hi, level + 1, lo, mid, left_lo, left_hi, sink, context);
+    search_range_tree(tree, range, x_lo, x_hi, level + 1, mid, hi, r_lo - left_lo, r_hi - left_hi, sink, context);
+}
+
+/**
+ * @brief Recursive function that counts the points of a node inside a range, as search_range_tree()
+ * @details with KD_DIM = 2 a node inside the range on x adds r_hi - r_lo without looking at its entries,
+ * so counting takes O(log n) whatever the answer
+ * @param tree The tree
+ * @param range The query range
+ * @param x_lo The first point with x inside the range
+ * @param x_hi One after the last point with x inside the range
+ * @param level The level of the node
+ * @param lo The first point of the node
+ * @param hi One after the last point of the node
+ * @param r_lo The rank of range->ymin in the node's list
+ * @param r_hi The rank of range->ymax in the node's list (one after the last y inside)
+ * @return the number of points
+*/
+int count_range_tree(RangeTree * tree, Range * range, int x_lo, int x_hi, int level, int lo, int hi, int r_lo, int r_hi) {
+    if (r_lo >= r_hi || hi <= x_lo || lo >= x_hi) return 0;
+
+    int inside = (lo >= x_lo && hi <= x_hi);
+
+#if KD_DIM == 2
+    (void)range;
+    if (inside) return r_hi - r_lo;
+#endif
+
+    if (!inside && hi - lo > tree->bucket) {
+        int mid = lo + (hi - lo + 1) / 2;
+        int left_lo = rank_left(tree, level, lo, hi, r_lo);
+        int left_hi = rank_left(tree, level, lo, hi, r_hi);
+
+        return count_range_tree(tree, range, x_lo, x_hi, level + 1, lo, mid, left_lo, left_hi)
+             + count_range_tree(tree, range, x_lo, x_hi, level + 1, mid, hi, r_lo - left_lo, r_hi - left_hi);
+    }
+
+    // a leaf, or a node inside on x and y with more coordinates to check
+    int * list = tree->index[level];
+    int count = 0;
+
+    for (int r = r_lo; r < r_hi; r++) {
+        int i = list[lo + r];
+        if (i < x_lo || i >= x_hi) continue;
+#if KD_DIM > 2
+        if (!point_in_range(&tree->points[i], range)) continue;
+#endif
+        count++;
+    }
+
+    return count;
+}
+
+/* ------------------------------ CORE FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function to build a range tree with the default leaf size (RANGE_TREE_BUCKET)
+ * @param points the set of points, reordered by x (the points themselves are copied)
+ * @param n the number of points in 'points'
+ * @return A pointer to the tree created
+*/
+RangeTree * buildRangeTree(Point ** points, int n) {
+    return buildRangeTreeBuckets(points, n, RANGE_TREE_BUCKET);
+}
+
+/**
+ * @brief Function to build a range tree whose leaves hold up to 'bucket' points
+ * @details O(n log n): one sort on x, one on y, then every level is split from the one above
+ * @param points the set of points, reordered by x (the points themselves are copied)
+ * @param n the number of points in 'points'
+ * @param bucket the most points in a leaf
+ * @return A pointer to the tree created
+*/
+RangeTree * buildRangeTreeBuckets(Point ** points, int n, int bucket) {
+    if (!points || n <= 0 || bucket < 1) return NULL;
+
+    RangeTree * tree = (RangeTree *)calloc(1, sizeof(struct range_tree));
+    struct y_entry * entries = (struct y_entry *)malloc(n * sizeof(struct y_entry));
+    int ok = tree && entries;
+
+    if (tree) {
+        tree->n = n;
+        tree->bucket = bucket;
+        tree->levels = range_tree_levels(n, bucket);
+        tree->points = (Point *)malloc(n * sizeof(Point));
+        tree->y = (double *)malloc(n * sizeof(double));
+        ok = ok && tree->points && tree->y && tree->levels <= RANGE_TREE_MAX_DEPTH;
+
+        for (int l = 0; ok && l < tree->levels; l++) {
+            tree->index[l] = (int *)malloc(n * sizeof(int));
+
+            // the last level only has leaves
+            if (l < tree->levels - 1) tree->left[l] = (int *)malloc(n * sizeof(int));
+
+            if (!tree->index[l] || (l < tree->levels - 1 && !tree->left[l])) ok = 0;
+        }
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(entries);
+        destroyRangeTree(tree);
+        return NULL;
+    }
+
+    // the main tree: the points by x
+    qsort(points, n, sizeof(Point *), point_order_qsort[0]);
+
+    for (int i = 0; i < n; i++) {
+        tree->points[i] = *points[i];
+        entries[i].y = points[i]->y;
+        entries[i].i = i;
+    }
+
+    // the list of the root: the same points by y
+    qsort(entries, n, sizeof(struct y_entry), y_entry_compare);
+
+    for (int r = 0; r < n; r++) {
+        tree->y[r] = entries[r].y;
+        tree->index[0][r] = entries[r].i;
+    }
+
+    free(entries);
+
+    build_range_level(tree, 0, 0, n);
+
+    return tree;
+}
+
+/**
+ * @brief Function search for points inside a given range and report them to a sink
+ * @details one binary search for each bound at the root (x in the points, y in the root's list), then the ranks are followed
+ * down the two paths to xmin and xmax, so a query takes O(log n + k) whatever its shape.
+ * The points reported are the ones stored in the tree, sorted by y within every node
+ * @param tree The tree
+ * @param range The query range
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink
+ * @return -
+*/
+void searchRangeTree(RangeTree * tree, Range * range, PointSink sink, void * context) {
+    if (!tree || !range || !sink) return;
+
+    int x_lo = rank_x(tree, range->xmin, 0);
+    int x_hi = rank_x(tree, range->xmax, 1);
+    int r_lo = rank_y(tree, range->ymin, 0);
+    int r_hi = rank_y(tree, range->ymax, 1);
+
+    search_range_tree(tree, range, x_lo, x_hi, 0, 0, tree->n, r_lo, r_hi, sink, context);
+}
+
+/**
+ * @brief Function to count the points inside a given range, without reporting them
+ * @param tree The tree
+ * @param range The query range
+ * @return the number of points inside the range
+*/
+int countRangeTree(RangeTree * tree, Range * range) {
+    if (!tree || !range) return 0;
+
+    int x_lo = rank_x(tree, range->xmin, 0);
+    int x_hi = rank_x(tree, range->xmax, 1);
+    int r_lo = rank_y(tree, range->ymin, 0);
+    int r_hi = rank_y(tree, range->ymax, 1);
+
+    return count_range_tree(tree, range, x_lo, x_hi, 0, 0, tree->n, r_lo, r_hi);
+}
+
+/**
+ * @brief Function that returns the memory used by a range tree
+ * @param tree The tree
+ * @return the number of bytes allocated for the tree and its arrays
+*/
+size_t rangeTreeMemory(RangeTree * tree) {
+    if (!tree) return 0;
+
+    size_t lists = (size_t)tree->levels * 2 - 1;
+
+    return sizeof(struct range_tree) + tree->n * (sizeof(Point) + sizeof(double) + lists * sizeof(int));
+}
+
+/**
+ * @brief Function to free a range tree
+ * @param tree The tree
+ * @return -
+*/
+void destroyRangeTree(RangeTree * tree) {
+    if (!tree) return;
+
+    for (int l = 0; l < RANGE_TREE_MAX_DEPTH; l++) {
+        free(tree->index[l]);
+        free(tree->left[l]);
+    }
+
+    free(tree->points);
+    free(tree->y);
+    free(tree);
+}
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * @file RangeTreeInterface.h
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief Interface for the 2-d range tree (RangeTreeImplementation.c), the same queries as the kd Tree in O(log n + k)
+*/
+
+#ifndef RANGE_TREE_INTERFACE_H
+#define RANGE_TREE_INTERFACE_H
+
+#include "PointInterface.h"
+#include "RangeInterface.h"
+#include "kdTreeInterface.h"
+
+// The deepest a tree can be (more than enough for any int number of points)
+#define RANGE_TREE_MAX_DEPTH 64
+
+// Most points in a leaf of the main tree
+#define RANGE_TREE_BUCKET 64
+
+// A layered range tree on x and y, with fractional cascading.
+//
+// The main tree is a balanced tree on x: the points are sorted by x and
+// a node is a slice [lo, hi) of them, split as in buildKDTree()
+// (ceil(n/2) points on the left). A node with at most 'bucket' points
+// is a leaf.
+//
+// Every node also has its points sorted by y (the associated structure).
+// The nodes of one level of the main tree are disjoint slices, so the
+// lists of a level are kept in one array of n entries: the list of node
+// [lo, hi) at level l is index[l][lo .. hi).
+//
+// Instead of a binary search in every list, the search follows ranks
+// down the tree (fractional cascading): left[l][lo + r] is how many of
+// the first r entries of the node's list belong to its left child, which
+// is also the rank of the same position in the left child's list (the
+// lists of the children are sublists of their parent's). The rank in the
+// right child is r minus that. Only the list of the root is searched,
+// with the y's in y.
+//
+// With KD_DIM > 2 only x and y are indexed, the other coordinates of the
+// points found are checked one by one.
+typedef struct range_tree {
+    // number of points
+    int n;
+
+    // most points in a leaf
+    int bucket;
+
+    // number of levels with lists (the leaves are on the last one at most)
+    int levels;
+
+    // the points, sorted by x
+    Point * points;
+
+    // the y's of the points in the list of the root, sorted
+    double * y;
+
+    // index[l][lo .. hi): the points of node [lo, hi) at level l sorted by y (positions in points)
+    int * index[RANGE_TREE_MAX_DEPTH];
+
+    // left[l][lo + r]: how many of index[l][lo .. lo + r) are in the left child of node [lo, hi)
+    int * left[RANGE_TREE_MAX_DEPTH];
+} RangeTree;
+
+RangeTree * buildRangeTree(Point **, int);
+
+RangeTree * buildRangeTreeBuckets(Point **, int, int);
+
+void searchRangeTree(RangeTree *, Range *, PointSink, void *);
+
+int countRangeTree(RangeTree *, Range *);
+
+size_t rangeTreeMemory(RangeTree *);
+
+void destroyRangeTree(RangeTree *);
+
+#endif
@@ -0,0 +1,286 @@
+/**
+ * @file SpaceCurveImplementation.c
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief Morton and Hilbert keys of points, and sorting points by them with a radix sort
+*/
+
+#ifndef SPACE_CURVE_IMPLEMENTATION_C
+#define SPACE_CURVE_IMPLEMENTATION_C
+
+// for memory allocation
+#include <stdlib.h>
+// for stderr use
+#include <stdio.h>
+// for memset
+#include <string.h>
+// for uint64_t
+#include <stdint.h>
+// all implemented header files in this directory
+#include "SpaceCurveInterface.h"
+#include "PointInterface.h"
+#include "RangeInterface.h"
+
+// bits of a key sorted by one pass of the radix sort
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define RADIX_PASSES ((CURVE_KEY_BITS + RADIX_BITS - 1) / RADIX_BITS)
+
+// a point while the points are sorted by key
+struct curve_entry {
+    uint64_t key;
+    int index;
+};
+
+/* ------------------------------ HELPER FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function to get the cell of a coordinate in the grid of a curve
+ * @param c the coordinate
+ * @param low the lower bound of the box on that axis
+ * @param scale (2^CURVE_BITS - 1) / (the length of the box on that axis), 0 if it has none
+ * @return floor((c - low) * scale), limited to [0, 2^CURVE_BITS - 1]
+*/
+uint32_t curve_cell(double c, double low, double scale) {
+    double top = (double)((UINT64_C(1) << CURVE_BITS) - 1);
+    double t = (c - low) * scale;
+
+    // also catches NaN
+    if (!(t > 0)) return 0;
+    if (t >= top) return (uint32_t)top;
+
+    return (uint32_t)t;
+}
+
+/**
+ * @brief Function that interleaves the bits of the cells, the highest bit of axis 0 first
+ * @param cell the cell on every axis (CURVE_BITS bits each)
+ * @return the interleaved bits (the Morton key)
+*/
+uint64_t curve_interleave(const uint32_t cell[KD_DIM]) {
+#if KD_DIM == 2
+    // the 16 bits of each spread to every other bit
+    uint64_t x = cell[0], y = cell[1];
+
+    x = (x | (x << 8)) & UINT64_C(0x00ff00ff);
+    x = (x | (x << 4)) & UINT64_C(0x0f0f0f0f);
+    x = (x | (x << 2)) & UINT64_C(0x33333333);
+    x = (x | (x << 1)) & UINT64_C(0x55555555);
+
+    y = (y | (y << 8)) & UINT64_C(0x00ff00ff);
+    y = (y | (y << 4)) & UINT64_C(0x0f0f0f0f);
+    y = (y | (y << 2)) & UINT64_C(0x33333333);
+    y = (y | (y << 1)) & UINT64_C(0x55555555);
+
+    return (x << 1) | y;
+#else
+    uint64_t key = 0;
+
+    for (int bit = CURVE_BITS - 1; bit >= 0; bit--)
+        for (int d = 0; d < KD_DIM; d++) key = (key << 1) | ((cell[d] >> bit) & 1);
+
+    return key;
+#endif
+}
+
+/**
+ * @brief Function that turns the cell of a point into the "transpose" of its Hilbert index, in place
+ * @details J. Skilling, "Programming the Hilbert curve" (2004): the bits of the index, interleaved as
+ * in curve_interleave(), are the bits of the result. It works for any number of coordinates
+ * @param cell the cell on every axis (CURVE_BITS bits each), replaced by the transpose
+ * @return -
+*/
+void hilbert_transpose(uint32_t cell[KD_DIM]) {
+    uint32_t top = UINT32_C(1) << (CURVE_BITS - 1);
+
+    // undo the rotations and reflections of the sub-cubes, from the largest to the smallest
+    for (uint32_t q = top; q > 1; q >>= 1) {
+        uint32_t p = q - 1;
+
+        for (int d = 0; d < KD_DIM; d++) {
+            if (cell[d] & q) {
+                cell[0] ^= p;
+            } else {
+                uint32_t t = (cell[0] ^ cell[d]) & p;
+                cell[0] ^= t;
+                cell[d] ^= t;
+            }
+        }
+    }
+
+    // Gray code
+    for (int d = 1; d < KD_DIM; d++) cell[d] ^= cell[d - 1];
+
+    uint32_t t = 0;
+
+    for (uint32_t q = top; q > 1; q >>= 1)
+        if (cell[KD_DIM - 1] & q) t ^= q - 1;
+
+    for (int d = 0; d < KD_DIM; d++) cell[d] ^= t;
+}
+
+/**
+ * @brief Function to compute the key of a point, with the scales of the box computed once
+ * @param p the point
+ * @param low the lower bound of the box on every axis
+ * @param scale the scale of every axis (see curve_cell())
+ * @param curve CURVE_MORTON or CURVE_HILBERT
+ * @return the key
+*/
+uint64_t curve_key_scaled(const Point * p, const double low[KD_DIM], const double scale[KD_DIM], Curve curve) {
+    uint32_t cell[KD_DIM];
+
+    for (int d = 0; d < KD_DIM; d++) cell[d] = curve_cell(p->c[d], low[d], scale[d]);
+
+    if (curve == CURVE_HILBERT) hilbert_transpose(cell);
+
+    return curve_interleave(cell);
+}
+
+/**
+ * @brief Function to get the lower bounds and the scales of a box, for curve_cell()
+ * @param bounds the box
+ * @param low gets the lower bound of every axis
+ * @param scale gets the scale of every axis
+ * @return -
+*/
+void curve_scales(const Range * bounds, double low[KD_DIM], double scale[KD_DIM]) {
+    double top = (double)((UINT64_C(1) << CURVE_BITS) - 1);
+
+    for (int d = 0; d < KD_DIM; d++) {
+        double length = bounds->b[d][1] - bounds->b[d][0];
+
+        low[d] = bounds->b[d][0];
+        scale[d] = (length > 0) ? top / length : 0;
+    }
+}
+
+/**
+ * @brief Function to sort entries by key, RADIX_BITS bits at a time from the lowest (LSD radix sort)
+ * @details the counts of every pass are taken in one pass over the keys first, and a pass where all
+ * the keys have the same digit is skipped (the high bits of few points, for example). Stable, O(n)
+ * @param entries the entries
+ * @param scratch room for n entries
+ * @param n the number of entries
+ * @return entries or scratch, whichever has the sorted entries
+*/
+struct curve_entry * radix_sort_curve(struct curve_entry * entries, struct curve_entry * scratch, int n) {
+    int counts[RADIX_PASSES][RADIX_SIZE];
+    memset(counts, 0, sizeof(counts));
+
+    for (int i = 0; i < n; i++)
+        for (int pass = 0; pass < RADIX_PASSES; pass++)
+            counts[pass][(entries[i].key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+        int * count = counts[pass];
+        int shift = pass * RADIX_BITS;
+
+        if (count[(entries[0].key >> shift) & (RADIX_SIZE - 1)] == n) continue;
+
+        // where every digit starts
+        for (int digit = 0, start = 0; digit < RADIX_SIZE; digit++) {
+            int size = count[digit];
+            count[digit] = start;
+            start += size;
+        }
+
+        for (int i = 0; i < n; i++) scratch[count[(entries[i].key >> shift) & (RADIX_SIZE - 1)]++] = entries[i];
+
+        struct curve_entry * swap = entries;
+        entries = scratch;
+        scratch = swap;
+    }
+
+    return entries;
+}
+
+/* ------------------------------ CORE FUNCTIONS ------------------------------ */
+
+/**
+ * @brief Function to compute the key of a point on a curve
+ * @param p the point
+ * @param bounds the box of the grid (usually range_bounding() of all the points)
+ * @param curve CURVE_MORTON or CURVE_HILBERT
+ * @return the place of the point's cell on the curve
+*/
+uint64_t curve_key(const Point * p, const Range * bounds, Curve curve) {
+    double low[KD_DIM], scale[KD_DIM];
+    curve_scales(bounds, low, scale);
+
+    return curve_key_scaled(p, low, scale, curve);
+}
+
+/**
+ * @brief Function to sort points along a curve, in the grid of their bounding box
+ * @details points in the same cell keep their order
+ * @param points the points, reordered
+ * @param n the number of points
+ * @param curve CURVE_MORTON or CURVE_HILBERT
+ * @return -
+*/
+void sortPointsCurve(Point ** points, int n, Curve curve) {
+    if (!points || n <= 1) return;
+
+    struct curve_entry * entries = (struct curve_entry *)malloc(n * sizeof(struct curve_entry));
+    struct curve_entry * scratch = (struct curve_entry *)malloc(n * sizeof(struct curve_entry));
+    Point ** order = (Point **)malloc(n * sizeof(Point *));
+
+    if (!entries || !scratch || !order) {
+        // the points just keep their order
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(entries);
+        free(scratch);
+        free(order);
+        return;
+    }
+
+    Range bounds = range_bounding(points, n);
+    double low[KD_DIM], scale[KD_DIM];
+    curve_scales(&bounds, low, scale);
+
+    for (int i = 0; i < n; i++) {
+        entries[i].key = curve_key_scaled(points[i], low, scale, curve);
+        entries[i].index = i;
+    }
+
+    struct curve_entry * sorted = radix_sort_curve(entries, scratch, n);
+
+    for (int i = 0; i < n; i++) order[i] = points[sorted[i].index];
+
+    memcpy(points, order, n * sizeof(Point *));
+
+    free(entries);
+    free(scratch);
+    free(order);
+}
+
+/**
+ * @brief Function to sort points along a curve and copy them into one array in that order,
+ * so points close in space are also close in memory (on the same cache lines and pages)
+ * @param points the points, reordered and changed to point into the new array (the old points are not freed)
+ * @param n the number of points
+ * @param curve CURVE_MORTON or CURVE_HILBERT
+ * @return the array with the copies (to be freed by the caller), NULL if allocation failed
+*/
+Point * layoutPointsCurve(Point ** points, int n, Curve curve) {
+    if (!points || n <= 0) return NULL;
+
+    Point * layout = (Point *)malloc(n * sizeof(Point));
+
+    if (!layout) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return NULL;
+    }
+
+    sortPointsCurve(points, n, curve);
+
+    for (int i = 0; i < n; i++) {
+        layout[i] = *points[i];
+        points[i] = &layout[i];
+    }
+
+    return layout;
+}
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * @file SpaceCurveInterface.h
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief Interface for ordering points along a space-filling curve (SpaceCurveImplementation.c)
+*/
+
+#ifndef SPACE_CURVE_INTERFACE_H
+#define SPACE_CURVE_INTERFACE_H
+
+#include <stdint.h>
+
+#include "PointInterface.h"
+#include "RangeInterface.h"
+
+// Bits of every coordinate in a key (all KD_DIM of them fit in 32 bits:
+// 2^16 cells on every axis in 2-d, finer than the points need to be
+// ordered, and the radix sort takes 4 passes)
+#define CURVE_BITS (32 / KD_DIM)
+
+// Bits of a key
+#define CURVE_KEY_BITS (CURVE_BITS * KD_DIM)
+
+// A space-filling curve visits every cell of a grid once, and points
+// close on the curve are close in space. The grid is the bounding box
+// of the points cut in 2^CURVE_BITS parts on every axis, and the key of
+// a point is the place of its cell on the curve.
+typedef enum curve {
+    CURVE_MORTON,   // Z-order: the bits of the cell's coordinates interleaved
+    CURVE_HILBERT   // Hilbert: consecutive cells always share a side, no jumps
+} Curve;
+
+uint64_t curve_key(const Point *, const Range *, Curve);
+
+// Sorts the pointers by the keys of their points, with a radix sort
+void sortPointsCurve(Point **, int, Curve);
+
+// The same, and copies the points into one array in that order (returned,
+// to be freed by the caller). The pointers are changed to point into it.
+Point * layoutPointsCurve(Point **, int, Curve);
+
+#endif
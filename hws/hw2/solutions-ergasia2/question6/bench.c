@@ -0,0 +1,532 @@
+/**
+ * @file bench.c
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief build and range query benchmark for the kd Tree on uniformly random points
+ * @details usage: ./bench [points] [queries] [query side] [neighbours]
+*/
+
+#ifndef BENCH_C
+#define BENCH_C
+
+// for memory allocation
+#include <stdlib.h>
+// for stdout and stderr use
+#include <stdio.h>
+// for clock_gettime
+#include <time.h>
+// for sqrt()
+#include <math.h>
+// for memcpy()
+#include <string.h>
+// all implemented header files in this directory
+#include "kdTreeInterface.h"
+#include "PointInterface.h"
+#include "RangeInterface.h"
+#include "PointBufferInterface.h"
+#include "FlatKDTreeInterface.h"
+#include "DynamicKDTreeInterface.h"
+#include "PointSetInterface.h"
+#include "RangeTreeInterface.h"
+#include "SpaceCurveInterface.h"
+
+/**
+ * @brief Function that returns the current time in seconds
+ * @return monotonic time in seconds
+*/
+double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Function that returns a random number in [min, max]
+ * @return the number
+*/
+double random_in(double min, double max) {
+    return min + (max - min) * rand() / RAND_MAX;
+}
+
+int main(int argc, char ** argv) {
+    int n = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int queries = (argc > 2) ? atoi(argv[2]) : 10000;
+    double side = (argc > 3) ? atof(argv[3]) : 0.5;
+    int k = (argc > 4) ? atoi(argv[4]) : 10;
+
+    if (n <= 0 || queries < 0 || side <= 0 || k <= 0) {
+        fprintf(stderr, "usage: %s [points] [queries] [query side] [neighbours]\n", argv[0]);
+        return 1;
+    }
+
+    srand(1);
+
+    Point ** points = (Point **)malloc(n * sizeof(Point *));
+    Range * ranges = (Range *)malloc((queries + 1) * sizeof(Range));
+
+    if (!points || !ranges) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return 1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        points[i] = point_init(random_in(PLANE_X_MIN, PLANE_X_MAX), random_in(PLANE_Y_MIN, PLANE_Y_MAX));
+        if (!points[i]) return 1;
+
+        // the coordinates after y (make DIM=3 and up)
+        for (int d = 2; d < KD_DIM; d++) points[i]->c[d] = random_in(PLANE_MIN, PLANE_MAX);
+    }
+
+    for (int i = 0; i < queries; i++) {
+        double x = random_in(PLANE_X_MIN, PLANE_X_MAX - side);
+        double y = random_in(PLANE_Y_MIN, PLANE_Y_MAX - side);
+
+        ranges[i] = range_plane();
+        ranges[i].xmin = x;
+        ranges[i].xmax = x + side;
+        ranges[i].ymin = y;
+        ranges[i].ymax = y + side;
+
+        for (int d = 2; d < KD_DIM; d++) {
+            ranges[i].b[d][0] = random_in(PLANE_MIN, PLANE_MAX - side);
+            ranges[i].b[d][1] = ranges[i].b[d][0] + side;
+        }
+    }
+
+    /* ----------------------- build ----------------------- */
+
+    const char * names[] = { "qsort", "presort", "select", "curve" };
+    KDNode * root = NULL;
+
+    // every build starts from the points in the order they were made (the builds reorder them)
+    Point ** order = (Point **)malloc(n * sizeof(Point *));
+    if (!order) return 1;
+
+    for (int mode = BUILD_QSORT; mode <= BUILD_CURVE; mode++) {
+        memcpy(order, points, n * sizeof(Point *));
+
+        double start = now();
+        KDNode * tree = buildKDTreeWith(order, n, (BuildMode)mode);
+        printf("build %-8s %d points: %.3f s\n", names[mode], n, now() - start);
+
+        if (!tree) return 1;
+
+        // keep the last one for the queries
+        if (root) destroyKDTree(root);
+        root = tree;
+    }
+
+    // the curve orders alone (BUILD_CURVE uses Morton)
+    const char * curves[] = { "morton", "hilbert" };
+
+    for (int curve = CURVE_MORTON; curve <= CURVE_HILBERT; curve++) {
+        memcpy(order, points, n * sizeof(Point *));
+
+        double start = now();
+        sortPointsCurve(order, n, (Curve)curve);
+        printf("sort %-9s %d points: %.3f s\n", curves[curve], n, now() - start);
+    }
+
+    for (int threads = 1; threads <= 4; threads *= 2) {
+        memcpy(order, points, n * sizeof(Point *));
+
+        double start = now();
+        KDNode * tree = buildKDTreeParallel(order, n, threads);
+        printf("build parallel %d points, %d threads: %.3f s\n", n, threads, now() - start);
+
+        if (!tree) return 1;
+
+        destroyKDTree(tree);
+    }
+
+    free(order);
+
+    /* ----------------------- range queries ----------------------- */
+
+    Range plane = range_plane();
+    PointBuffer * results = point_buffer_init(1024);
+    if (!results) return 1;
+
+    long reported = 0;
+    double start = now();
+
+    for (int i = 0; i < queries; i++) {
+        point_buffer_clear(results);
+        searchKDTreeSink(root, &ranges[i], &plane, point_buffer_add, results);
+        if (results->failed) return 1;
+        reported += results->count;
+    }
+
+    double seconds = now() - start;
+
+    if (queries > 0)
+        printf("kd tree:      %d queries of side %g: %.3f s, %.2f us/query, %.1f points/query\n",
+               queries, side, seconds, seconds * 1e6 / queries, (double)reported / queries);
+
+    /* ----------------------- the same queries as a batch, on several threads ----------------------- */
+
+    PointBuffer ** batch = (PointBuffer **)malloc((queries + 1) * sizeof(PointBuffer *));
+    if (!batch) return 1;
+
+    for (int i = 0; i < queries; i++) {
+        batch[i] = point_buffer_init(16);
+        if (!batch[i]) return 1;
+    }
+
+    for (int spatial = 0; spatial <= 1; spatial++) {
+        for (int threads = 1; threads <= 8; threads *= 2) {
+            start = now();
+            int failed = searchKDTreeBatch(root, ranges, queries, &plane, batch, threads, spatial);
+            seconds = now() - start;
+
+            if (failed > 0) return 1;
+
+            if (queries > 0)
+                printf("kd tree:      batch of %d queries, %d threads%s: %.3f s, %.0f queries/s\n",
+                       queries, threads, spatial ? ", Z-order" : "", seconds, queries / seconds);
+        }
+    }
+
+    for (int i = 0; i < queries; i++) point_buffer_destroy(batch[i]);
+    free(batch);
+
+    /* ----------------------- counting only ----------------------- */
+
+    long counted = 0;
+    start = now();
+
+    for (int i = 0; i < queries; i++) counted += countKDTree(root, &ranges[i], &plane);
+
+    seconds = now() - start;
+
+    if (queries > 0)
+        printf("kd tree:      %d counts of side %g: %.3f s, %.2f us/query, %.1f points/query\n",
+               queries, side, seconds, seconds * 1e6 / queries, (double)counted / queries);
+
+    /* ----------------------- k nearest neighbours at the centers of the ranges ----------------------- */
+
+    // the centers of the ranges
+    Point * centers = (Point *)malloc((queries + 1) * sizeof(Point));
+    Neighbour * neighbours = (Neighbour *)malloc(((size_t)queries + 1) * k * sizeof(Neighbour));
+    int * found = (int *)malloc((queries + 1) * sizeof(int));
+
+    if (!centers || !neighbours || !found) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return 1;
+    }
+
+    for (int i = 0; i < queries; i++) {
+        for (int d = 0; d < KD_DIM; d++) centers[i].c[d] = (ranges[i].b[d][0] + ranges[i].b[d][1]) / 2;
+    }
+
+    start = now();
+    for (int i = 0; i < queries; i++) knnKDTree(root, &centers[i], k, neighbours + (size_t)i * k);
+    seconds = now() - start;
+
+    if (queries > 0)
+        printf("kd tree:      %d queries of %d neighbours: %.3f s, %.2f us/query\n", queries, k, seconds, seconds * 1e6 / queries);
+
+    start = now();
+    knnKDTreeBatch(root, centers, queries, k, neighbours, found);
+    seconds = now() - start;
+
+    if (queries > 0)
+        printf("kd tree:      %d queries of %d neighbours in a batch: %.3f s, %.2f us/query\n", queries, k, seconds, seconds * 1e6 / queries);
+
+    /* ----------------------- circles around the same centers ----------------------- */
+
+    reported = 0;
+    start = now();
+
+    for (int i = 0; i < queries; i++) {
+        point_buffer_clear(results);
+        radiusKDTree(root, &centers[i], side / 2, &plane, point_buffer_add, results);
+        if (results->failed) return 1;
+        reported += results->count;
+    }
+
+    seconds = now() - start;
+
+    if (queries > 0)
+        printf("kd tree:      %d circles of radius %g: %.3f s, %.2f us/query, %.1f points/query\n",
+               queries, side / 2, seconds, seconds * 1e6 / queries, (double)reported / queries);
+
+    free(centers);
+    free(neighbours);
+    free(found);
+
+    /* ----------------------- the same on the flat tree, for every leaf size ----------------------- */
+
+    int buckets[] = { 1, 8, 16, 32, 64 };
+    int count = sizeof(buckets) / sizeof(buckets[0]);
+    int best = 0;
+    double best_seconds = 0;
+
+    for (int b = 0; b < count; b++) {
+        start = now();
+        FlatKDTree * flat = buildFlatKDTreeBuckets(points, n, buckets[b]);
+        printf("build flat, leaves of %-2d %d points: %.3f s\n", buckets[b], n, now() - start);
+
+        if (!flat) return 1;
+
+        reported = 0;
+        start = now();
+
+        for (int i = 0; i < queries; i++) {
+            point_buffer_clear(results);
+            searchFlatKDTree(flat, &ranges[i], &plane, point_buffer_add, results);
+            if (results->failed) return 1;
+            reported += results->count;
+        }
+
+        seconds = now() - start;
+
+        if (queries > 0)
+            printf("flat kd tree, leaves of %-2d %d queries of side %g: %.3f s, %.2f us/query, %.1f points/query\n",
+                   buckets[b], queries, side, seconds, seconds * 1e6 / queries, (double)reported / queries);
+
+        if (b == 0 || seconds < best_seconds) {
+            best = b;
+            best_seconds = seconds;
+        }
+
+        destroyFlatKDTree(flat);
+    }
+
+    if (queries > 0) printf("fastest leaf size: %d\n", buckets[best]);
+
+    /* ----------------------- the same on the fastest leaf size, for every coordinate storage ----------------------- */
+
+    const char * storages[] = { "double", "float", "quant32", "quant16" };
+
+    for (int storage = FLAT_DOUBLE; storage <= FLAT_QUANT16; storage++) {
+        FlatKDTree * flat = buildFlatKDTreeStorage(points, n, buckets[best], (FlatStorage)storage);
+        if (!flat) return 1;
+
+        reported = 0;
+        start = now();
+
+        for (int i = 0; i < queries; i++) {
+            point_buffer_clear(results);
+            searchFlatKDTree(flat, &ranges[i], &plane, point_buffer_add, results);
+            if (results->failed) return 1;
+            reported += results->count;
+        }
+
+        seconds = now() - start;
+
+        printf("flat kd tree, %-7s %.1f bytes/point", storages[storage], (double)flatKDTreeMemory(flat) / n);
+        if (queries > 0)
+            printf(", %d queries of side %g: %.3f s, %.2f us/query, %.1f points/query",
+                   queries, side, seconds, seconds * 1e6 / queries, (double)reported / queries);
+        printf("\n");
+
+        destroyFlatKDTree(flat);
+    }
+
+    /* ----------------------- a saved flat tree, opened from the file ----------------------- */
+
+    const char * path = "bench_tree.bin";
+    FlatKDTree * flat = buildFlatKDTreeBuckets(points, n, buckets[best]);
+    if (!flat) return 1;
+
+    start = now();
+    int saved = saveFlatKDTree(flat, path);
+    seconds = now() - start;
+    destroyFlatKDTree(flat);
+
+    if (saved) {
+        printf("saved flat:   %d points: %.3f s\n", n, seconds);
+
+        start = now();
+        flat = openFlatKDTree(path);
+        seconds = now() - start;
+        if (!flat) return 1;
+
+        printf("saved flat:   open: %.1f us\n", seconds * 1e6);
+
+        // the first queries also read the pages of the file they need
+        reported = 0;
+        start = now();
+
+        for (int i = 0; i < queries; i++) {
+            point_buffer_clear(results);
+            searchFlatKDTree(flat, &ranges[i], &plane, point_buffer_add, results);
+            if (results->failed) return 1;
+            reported += results->count;
+        }
+
+        seconds = now() - start;
+
+        if (queries > 0)
+            printf("saved flat:   %d queries of side %g: %.3f s, %.2f us/query, %.1f points/query\n",
+                   queries, side, seconds, seconds * 1e6 / queries, (double)reported / queries);
+
+        destroyFlatKDTree(flat);
+        remove(path);
+    }
+
+    /* ----------------------- the range tree, against the kd Trees for thin ranges ----------------------- */
+
+    start = now();
+    RangeTree * range_tree = buildRangeTree(points, n);
+    seconds = now() - start;
+    if (!range_tree) return 1;
+
+    printf("range tree:   build %d points: %.3f s, %.1f bytes/point\n", n, seconds, (double)rangeTreeMemory(range_tree) / n);
+
+    flat = buildFlatKDTreeBuckets(points, n, buckets[best]);
+    if (!flat) return 1;
+
+    // the linked tree has 2n - 1 nodes and a copy of every point (not counting malloc's own overhead)
+    printf("kd tree:      about %.1f bytes/point, flat kd tree (leaves of %d): %.1f bytes/point\n",
+           (double)((2.0 * n - 1) * sizeof(KDNode) + n * sizeof(Point)) / n, buckets[best], (double)flatKDTreeMemory(flat) / n);
+
+    // ranges with the area of a square of the query side, 'aspect' times longer than they are wide,
+    // half of them along x and half along y
+    Range * thin = (Range *)malloc((queries + 1) * sizeof(Range));
+    if (!thin) return 1;
+
+    for (int aspect = 1; aspect <= 4096; aspect *= 16) {
+        double length = side * sqrt(aspect), width = side / sqrt(aspect);
+
+        if (length > PLANE_X_MAX - PLANE_X_MIN) length = PLANE_X_MAX - PLANE_X_MIN;
+
+        for (int i = 0; i < queries; i++) {
+            double w = (i % 2) ? width : length, h = (i % 2) ? length : width;
+            double x = random_in(PLANE_X_MIN, PLANE_X_MAX - w);
+            double y = random_in(PLANE_Y_MIN, PLANE_Y_MAX - h);
+
+            thin[i] = range_plane();
+            thin[i].xmin = x;
+            thin[i].xmax = x + w;
+            thin[i].ymin = y;
+            thin[i].ymax = y + h;
+        }
+
+        const char * indexes[] = { "kd tree", "flat kd tree", "range tree" };
+
+        for (int index = 0; index < 3; index++) {
+            reported = 0;
+            start = now();
+
+            for (int i = 0; i < queries; i++) {
+                point_buffer_clear(results);
+
+                if (index == 0) searchKDTreeSink(root, &thin[i], &plane, point_buffer_add, results);
+                else if (index == 1) searchFlatKDTree(flat, &thin[i], &plane, point_buffer_add, results);
+                else searchRangeTree(range_tree, &thin[i], point_buffer_add, results);
+
+                if (results->failed) return 1;
+                reported += results->count;
+            }
+
+            seconds = now() - start;
+
+            if (queries > 0)
+                printf("aspect %-4d   %-12s %d queries: %.3f s, %.2f us/query, %.1f points/query\n",
+                       aspect, indexes[index], queries, seconds, seconds * 1e6 / queries, (double)reported / queries);
+        }
+    }
+
+    free(thin);
+    destroyFlatKDTree(flat);
+    destroyRangeTree(range_tree);
+
+    /* ----------------------- the dynamic tree: insert every point, delete half of them ----------------------- */
+
+    DynamicKDTree * dynamic = createDynamicKDTree();
+    if (!dynamic) return 1;
+
+    start = now();
+    for (int i = 0; i < n; i++) insertDynamicKDTree(dynamic, points[i]);
+    seconds = now() - start;
+    printf("dynamic:      %d inserts: %.3f s, %.2f us/insert\n", n, seconds, seconds * 1e6 / n);
+
+    start = now();
+    for (int i = 0; i < n; i += 2) deleteDynamicKDTree(dynamic, points[i]);
+    seconds = now() - start;
+    printf("dynamic:      %d deletes: %.3f s, %.2f us/delete\n", (n + 1) / 2, seconds, seconds * 1e6 / ((n + 1) / 2));
+
+    counted = 0;
+    start = now();
+
+    for (int i = 0; i < queries; i++) counted += countDynamicKDTree(dynamic, &ranges[i], &plane);
+
+    seconds = now() - start;
+
+    if (queries > 0)
+        printf("dynamic:      %d counts of side %g: %.3f s, %.2f us/query, %.1f points/query\n",
+               queries, side, seconds, seconds * 1e6 / queries, (double)counted / queries);
+
+    destroyDynamicKDTree(dynamic);
+
+    /* ----------------------- loading the points from files ----------------------- */
+
+    const char * csv_path = "bench_points.csv";
+    const char * bin_path = "bench_points.bin";
+    FILE * csv = fopen(csv_path, "w");
+    FILE * bin = fopen(bin_path, "wb");
+
+    if (csv && bin) {
+        // six decimals, as point files usually have
+        for (int i = 0; i < n; i++) {
+            for (int d = 0; d < KD_DIM; d++) fprintf(csv, (d < KD_DIM - 1) ? "%.6f," : "%.6f\n", points[i]->c[d]);
+            fwrite(points[i]->c, sizeof(double), KD_DIM, bin);
+        }
+    }
+
+    if (csv) fclose(csv);
+    if (bin) fclose(bin);
+
+    if (csv && bin) {
+        // the usual way, for comparison
+        csv = fopen(csv_path, "r");
+        int scanned = 0;
+        double value;
+        start = now();
+
+        while (csv && fscanf(csv, "%lf%*c", &value) == 1) scanned++;
+
+        seconds = now() - start;
+        if (csv) fclose(csv);
+        printf("load csv:     fscanf: %d points: %.3f s\n", scanned / KD_DIM, seconds);
+
+        const char * ways[] = { "read", "mmap" };
+
+        for (int use_mmap = 0; use_mmap <= 1; use_mmap++) {
+            start = now();
+            PointSet * set = point_set_load_csv(csv_path, use_mmap);
+            seconds = now() - start;
+
+            if (set) printf("load csv:     %s: %d points: %.3f s, %.1f ns/point\n", ways[use_mmap], set->n, seconds, seconds * 1e9 / n);
+            point_set_destroy(set);
+        }
+
+        for (int use_mmap = 0; use_mmap <= 1; use_mmap++) {
+            start = now();
+            PointSet * set = point_set_load_binary(bin_path, use_mmap);
+            seconds = now() - start;
+
+            if (set) printf("load binary:  %s: %d points: %.3f s, %.1f ns/point\n", ways[use_mmap], set->n, seconds, seconds * 1e9 / n);
+            point_set_destroy(set);
+        }
+    }
+
+    remove(csv_path);
+    remove(bin_path);
+
+    /* ----------------------- free memory ----------------------- */
+
+    point_buffer_destroy(results);
+    destroyKDTree(root);
+
+    for (int i = 0; i < n; i++) free(points[i]);
+
+    free(points);
+    free(ranges);
+
+    return 0;
+}
+
+#endif
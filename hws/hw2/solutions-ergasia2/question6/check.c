@@ -0,0 +1,762 @@
+/**
+ * @file check.c
+ * @author Anastasia Marinakou | sdi2400120
+ * @details Course: Data Structures and Programing Techniques (Even)
+ * @brief brute force check of every tree of this directory: the answer of every query is
+ * compared with the one found by checking all the points
+ * @details built and run by make check for 2, 3 and 8 coordinates. The points are random or on a small grid
+ * (many equal coordinates and equal points).
+ * usage: ./check-2 [seed]
+*/
+
+#ifndef CHECK_C
+#define CHECK_C
+
+// for memory allocation
+#include <stdlib.h>
+// for stdout and stderr use
+#include <stdio.h>
+// for sqrt()
+#include <math.h>
+// for memcmp()
+#include <string.h>
+// for unlink()
+#include <unistd.h>
+// all implemented header files in this directory
+#include "kdTreeInterface.h"
+#include "PointInterface.h"
+#include "RangeInterface.h"
+#include "PointBufferInterface.h"
+#include "FlatKDTreeInterface.h"
+#include "DynamicKDTreeInterface.h"
+#include "PointSetInterface.h"
+#include "RangeTreeInterface.h"
+#include "SpaceCurveInterface.h"
+
+// queries of every kind on every tree
+#define CHECK_QUERIES 40
+
+// most neighbours asked for
+#define CHECK_K 12
+
+// where saveFlatKDTree() writes the tree opened again
+#define CHECK_FILE "check.flat"
+
+// where the points are written to be loaded again
+#define CHECK_CSV "check.csv"
+#define CHECK_BIN "check.bin"
+
+int Checks = 0;
+int Failed = 0;
+
+// the points of the current set, their bounding box and the queries on them
+Point * Points;
+int N;
+Range Bounds;
+Range Ranges[CHECK_QUERIES];
+Point Centers[CHECK_QUERIES];
+double Radii[CHECK_QUERIES];
+
+/**
+ * @brief Function that returns a random number in [min, max]
+ * @return the number
+*/
+double random_in(double min, double max) {
+    return min + (max - min) * rand() / RAND_MAX;
+}
+
+/**
+ * @brief Function that orders points by their coordinates, for qsort()
+ * @return the order of a and b
+*/
+int compare_points(const void * a, const void * b) {
+    const Point * p = (const Point *)a;
+    const Point * q = (const Point *)b;
+
+    for (int d = 0; d < KD_DIM; d++) {
+        if (p->c[d] < q->c[d]) return -1;
+        if (p->c[d] > q->c[d]) return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Function that orders doubles, for qsort()
+ * @return the order of a and b
+*/
+int compare_doubles(const void * a, const void * b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Function that returns the squared distance of two points, summed in the same order as the trees do
+ * @return the squared distance
+*/
+double squared(const Point * p, const Point * q) {
+    double sum = 0;
+
+    for (int d = 0; d < KD_DIM; d++) sum += (p->c[d] - q->c[d]) * (p->c[d] - q->c[d]);
+
+    return sum;
+}
+
+/**
+ * @brief Function that records the result of one check and prints it if it failed
+ * @param ok 1 if the check passed
+ * @param what what was checked
+ * @param query the number of the query
+ * @return -
+*/
+void expect(int ok, const char * what, int query) {
+    Checks++;
+
+    if (ok) return;
+
+    Failed++;
+    if (Failed <= 20) printf("FAILED: D=%d n=%d %s (query %d)\n", KD_DIM, N, what, query);
+}
+
+/**
+ * @brief Function that checks the points a query reported against the points of the set that should be reported
+ * @param got the points reported (sorted here)
+ * @param inside returns 1 for a point of the set that should be reported
+ * @param query the number of the query
+ * @return 1 if they are the same points (equal points as many times) and the buffer lost none, 0 otherwise
+*/
+int same_points(PointBuffer * got, int (* inside)(Point *, int), int query) {
+    Point * want = (Point *)malloc((N + 1) * sizeof(Point));
+    Point * found = (Point *)malloc((got->count + 1) * sizeof(Point));
+
+    if (!want || !found) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        exit(1);
+    }
+
+    int m = 0;
+    for (int i = 0; i < N; i++)
+        if (inside(&Points[i], query)) want[m++] = Points[i];
+
+    for (int i = 0; i < got->count; i++) found[i] = *got->points[i];
+
+    int ok = (!got->failed && m == got->count);
+
+    if (ok) {
+        qsort(want, m, sizeof(Point), compare_points);
+        qsort(found, m, sizeof(Point), compare_points);
+        ok = (m == 0 || memcmp(want, found, m * sizeof(Point)) == 0);
+    }
+
+    free(want);
+    free(found);
+
+    return ok;
+}
+
+/**
+ * @brief Function that tells if a point is inside the range of a query
+ * @return 1 if it is
+*/
+int in_range(Point * p, int query) {
+    return point_in_range(p, &Ranges[query]);
+}
+
+/**
+ * @brief Function that tells if a point is inside the circle of a query
+ * @return 1 if it is
+*/
+int in_circle(Point * p, int query) {
+    return squared(p, &Centers[query]) <= Radii[query] * Radii[query];
+}
+
+/**
+ * @brief Function that returns the number of points inside the range of a query
+ * @return the number of points
+*/
+int count_in_range(int query) {
+    int count = 0;
+    for (int i = 0; i < N; i++) count += in_range(&Points[i], query);
+    return count;
+}
+
+/**
+ * @brief Function that checks the neighbours found for a query point against the k closest points of the set
+ * @details equal distances can be any of the points at that distance, so only the distances are compared
+ * @param out the neighbours found, closest first
+ * @param found the number of neighbours found
+ * @param query the query point
+ * @param k the number of neighbours asked for
+ * @return 1 if they are right
+*/
+int same_neighbours(Neighbour * out, int found, Point * query, int k) {
+    double * distances = (double *)malloc((N + 1) * sizeof(double));
+
+    if (!distances) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < N; i++) distances[i] = sqrt(squared(&Points[i], query));
+    qsort(distances, N, sizeof(double), compare_doubles);
+
+    int ok = (found == (k < N ? k : N));
+
+    for (int i = 0; ok && i < found; i++)
+        ok = (fabs(out[i].distance - distances[i]) <= 1e-9 * (1 + distances[i])) && (i == 0 || out[i - 1].distance <= out[i].distance);
+
+    free(distances);
+
+    return ok;
+}
+
+/**
+ * @brief Function that tells if a point of the set is in the tree, for ReportSubtreeSink() of the root
+ * @return 1
+*/
+int in_tree(Point * p, int query) {
+    (void)p;
+    (void)query;
+    return 1;
+}
+
+/**
+ * @brief Function that checks that every subtree is the slice [begin, end) of the leaf-ordered array of the tree
+ * @param node the subtree
+ * @param base the array of the tree
+ * @param begin where the slice of the subtree should start
+ * @return where it ends, -1 if a node is wrong
+*/
+int leaf_slices(KDNode * node, Point * base, int begin) {
+    if (node->begin != begin || node->point != base + begin || node->count != node->end - node->begin) return -1;
+
+    if (node->type == LEAF_NODE) return (node->end == begin + 1) ? node->end : -1;
+
+    int middle = leaf_slices(node->left, base, begin);
+    if (middle < 0) return -1;
+
+    int end = leaf_slices(node->right, base, middle);
+    return (end == node->end) ? end : -1;
+}
+
+/**
+ * @brief Function that runs every query on a linked kd Tree
+ * @param root the tree
+ * @param name how it was built
+ * @return -
+*/
+void check_kdtree(KDNode * root, const char * name) {
+    char what[128];
+    // room for one point, so the buffer has to grow during the queries
+    PointBuffer * b = point_buffer_init(1);
+    Neighbour out[CHECK_K];
+
+    if (!b) exit(1);
+
+    // the points of every subtree are next to each other, in the order of the leaves
+    sprintf(what, "%s: leaf order", name);
+    expect(leaf_slices(root, root->point, 0) == N, what, -1);
+
+    ReportSubtreeSink(root, point_buffer_add, b);
+    sprintf(what, "%s: ReportSubtreeSink()", name);
+    expect(same_points(b, in_tree, -1), what, -1);
+
+    for (int q = 0; q < CHECK_QUERIES; q++) {
+        // NULL is all of space, which holds the points outside the plane too
+        point_buffer_clear(b);
+        searchKDTreeSink(root, &Ranges[q], NULL, point_buffer_add, b);
+        sprintf(what, "%s: searchKDTreeSink()", name);
+        expect(same_points(b, in_range, q), what, q);
+
+        point_buffer_clear(b);
+        searchKDTreeSink(root, &Ranges[q], &Bounds, point_buffer_add, b);
+        sprintf(what, "%s: searchKDTreeSink() in the bounding box", name);
+        expect(same_points(b, in_range, q), what, q);
+
+        sprintf(what, "%s: countKDTree()", name);
+        expect(countKDTree(root, &Ranges[q], NULL) == count_in_range(q), what, q);
+
+        point_buffer_clear(b);
+        radiusKDTree(root, &Centers[q], Radii[q], NULL, point_buffer_add, b);
+        sprintf(what, "%s: radiusKDTree()", name);
+        expect(same_points(b, in_circle, q), what, q);
+
+        int k = 1 + q % CHECK_K;
+        int found = knnKDTree(root, &Centers[q], k, out);
+        sprintf(what, "%s: knnKDTree()", name);
+        expect(same_neighbours(out, found, &Centers[q], k), what, q);
+    }
+
+    // batches, on 3 threads, in the given order and in Z-order
+    PointBuffer * results[CHECK_QUERIES];
+
+    for (int q = 0; q < CHECK_QUERIES; q++) {
+        results[q] = point_buffer_init(1);
+        if (!results[q]) exit(1);
+    }
+
+    for (int spatial = 0; spatial <= 1; spatial++) {
+        int failed = searchKDTreeBatch(root, Ranges, CHECK_QUERIES, NULL, results, 3, spatial);
+        sprintf(what, "%s: searchKDTreeBatch(spatial = %d)", name, spatial);
+        expect(failed == 0, what, -1);
+
+        for (int q = 0; q < CHECK_QUERIES; q++) expect(same_points(results[q], in_range, q), what, q);
+    }
+
+    for (int q = 0; q < CHECK_QUERIES; q++) point_buffer_destroy(results[q]);
+
+    Neighbour * batch = (Neighbour *)malloc(CHECK_QUERIES * CHECK_K * sizeof(Neighbour));
+    int found[CHECK_QUERIES];
+
+    if (!batch) exit(1);
+
+    knnKDTreeBatch(root, Centers, CHECK_QUERIES, CHECK_K, batch, found);
+
+    for (int q = 0; q < CHECK_QUERIES; q++) {
+        sprintf(what, "%s: knnKDTreeBatch()", name);
+        expect(same_neighbours(batch + q * CHECK_K, found[q], &Centers[q], CHECK_K), what, q);
+    }
+
+    free(batch);
+    point_buffer_destroy(b);
+}
+
+/**
+ * @brief Function that checks that two trees have the same nodes (lines, axes and counts)
+ * @return 1 if they do
+*/
+int same_tree(KDNode * a, KDNode * b) {
+    if (!a || !b) return a == b;
+
+    if (a->type != b->type || a->count != b->count) return 0;
+    if (a->type == LEAF_NODE) return point_equal(a->point, b->point);
+    if (a->line != b->line) return 0;
+
+    return same_tree(a->left, b->left) && same_tree(a->right, b->right);
+}
+
+/**
+ * @brief Function that builds the linked kd Tree in every way and checks them
+ * @return -
+*/
+void check_builds(void) {
+    static const char * modes[] = { "BUILD_QSORT", "BUILD_PRESORT", "BUILD_SELECT", "BUILD_CURVE" };
+    Point ** pointers = (Point **)malloc((N + 1) * sizeof(Point *));
+
+    if (!pointers) exit(1);
+
+    // every builder may reorder the pointers, so each one gets them in the original order
+    for (int i = 0; i < N; i++) pointers[i] = &Points[i];
+    KDNode * reference = buildKDTree(pointers, N, 0);
+    check_kdtree(reference, "buildKDTree()");
+
+    for (int mode = BUILD_QSORT; mode <= BUILD_CURVE; mode++) {
+        for (int i = 0; i < N; i++) pointers[i] = &Points[i];
+        KDNode * root = buildKDTreeWith(pointers, N, (BuildMode)mode);
+
+        expect(same_tree(root, reference), modes[mode], 0);
+        check_kdtree(root, modes[mode]);
+        destroyKDTree(root);
+    }
+
+    for (int threads = 2; threads <= 5; threads += 3) {
+        for (int i = 0; i < N; i++) pointers[i] = &Points[i];
+        KDNode * root = buildKDTreeParallel(pointers, N, threads);
+
+        expect(same_tree(root, reference), "buildKDTreeParallel()", threads);
+        check_kdtree(root, "buildKDTreeParallel()");
+        destroyKDTree(root);
+    }
+
+    destroyKDTree(reference);
+    free(pointers);
+}
+
+/**
+ * @brief Function that checks the order of sortPointsCurve() and the copies of layoutPointsCurve() on both curves
+ * @details the keys must not decrease, points with the same key keep their order, and the
+ * copies must be the sorted points, with the pointers moved to them
+ * @return -
+*/
+void check_curves(void) {
+    static const char * curves[] = { "CURVE_MORTON", "CURVE_HILBERT" };
+    char what[128];
+    Point ** sorted = (Point **)malloc((N + 1) * sizeof(Point *));
+    Point ** laid = (Point **)malloc((N + 1) * sizeof(Point *));
+
+    if (!sorted || !laid) exit(1);
+
+    for (int c = CURVE_MORTON; c <= CURVE_HILBERT; c++) {
+        for (int i = 0; i < N; i++) sorted[i] = laid[i] = &Points[i];
+
+        sortPointsCurve(sorted, N, (Curve)c);
+
+        // the pointers start in the order of Points, so a stable sort keeps equal keys in address order
+        int ordered = 1;
+        int * seen = (int *)calloc(N + 1, sizeof(int));
+        if (!seen) exit(1);
+
+        for (int i = 0; i < N; i++) {
+            seen[sorted[i] - Points]++;
+            if (i == 0) continue;
+
+            uint64_t before = curve_key(sorted[i - 1], &Bounds, (Curve)c);
+            uint64_t key = curve_key(sorted[i], &Bounds, (Curve)c);
+
+            if (before > key || (before == key && sorted[i - 1] > sorted[i])) ordered = 0;
+        }
+
+        for (int i = 0; i < N; i++) ordered = ordered && seen[i] == 1;
+        free(seen);
+
+        sprintf(what, "sortPointsCurve(%s)", curves[c]);
+        expect(ordered, what, -1);
+
+        Point * copies = layoutPointsCurve(laid, N, (Curve)c);
+        int same = (copies != NULL);
+
+        for (int i = 0; same && i < N; i++) same = (laid[i] == &copies[i]) && point_equal(&copies[i], sorted[i]);
+
+        sprintf(what, "layoutPointsCurve(%s)", curves[c]);
+        expect(same, what, -1);
+        free(copies);
+    }
+
+    free(sorted);
+    free(laid);
+}
+
+/**
+ * @brief Function that runs the range queries on a flat kd Tree
+ * @param tree the tree
+ * @param name how it was built
+ * @return -
+*/
+void check_flat_queries(FlatKDTree * tree, const char * name) {
+    PointBuffer * b = point_buffer_init(16);
+    if (!b) exit(1);
+
+    for (int q = 0; q < CHECK_QUERIES; q++) {
+        point_buffer_clear(b);
+        searchFlatKDTree(tree, &Ranges[q], NULL, point_buffer_add, b);
+        expect(same_points(b, in_range, q), name, q);
+    }
+
+    point_buffer_destroy(b);
+}
+
+/**
+ * @brief Function that builds the flat kd Tree with every storage and a few leaf sizes, saves and opens it, and checks them
+ * @details leaves of 3 points leave a tail after the vector part of the leaf filters
+ * @return -
+*/
+void check_flat(void) {
+    static const char * storages[] = { "FLAT_DOUBLE", "FLAT_FLOAT", "FLAT_QUANT32", "FLAT_QUANT16" };
+    static const int buckets[] = { 1, 3, 16, 64 };
+    char what[128];
+    Point ** pointers = (Point **)malloc((N + 1) * sizeof(Point *));
+
+    if (!pointers) exit(1);
+
+    for (int s = FLAT_DOUBLE; s <= FLAT_QUANT16; s++) {
+        for (int k = 0; k < 4; k++) {
+            for (int i = 0; i < N; i++) pointers[i] = &Points[i];
+
+            FlatKDTree * tree = buildFlatKDTreeStorage(pointers, N, buckets[k], (FlatStorage)s);
+            sprintf(what, "searchFlatKDTree(%s, leaves of %d)", storages[s], buckets[k]);
+            expect(tree != NULL, what, -1);
+            if (!tree) continue;
+
+            check_flat_queries(tree, what);
+
+            // the same tree, used straight from its file
+            if (saveFlatKDTree(tree, CHECK_FILE)) {
+                FlatKDTree * opened = openFlatKDTree(CHECK_FILE);
+                sprintf(what, "openFlatKDTree(%s, leaves of %d)", storages[s], buckets[k]);
+                expect(opened != NULL, what, -1);
+
+                if (opened) check_flat_queries(opened, what);
+                destroyFlatKDTree(opened);
+            } else {
+                expect(0, "saveFlatKDTree()", -1);
+            }
+
+            unlink(CHECK_FILE);
+            destroyFlatKDTree(tree);
+        }
+    }
+
+    free(pointers);
+}
+
+/**
+ * @brief Function that builds the range tree with a few leaf sizes and checks it
+ * @return -
+*/
+void check_range_tree(void) {
+    static const int buckets[] = { 1, 7, RANGE_TREE_BUCKET };
+    char what[128];
+    Point ** pointers = (Point **)malloc((N + 1) * sizeof(Point *));
+    PointBuffer * b = point_buffer_init(16);
+
+    if (!pointers || !b) exit(1);
+
+    for (int k = 0; k < 3; k++) {
+        for (int i = 0; i < N; i++) pointers[i] = &Points[i];
+
+        RangeTree * tree = buildRangeTreeBuckets(pointers, N, buckets[k]);
+        sprintf(what, "buildRangeTreeBuckets(%d)", buckets[k]);
+        expect(tree != NULL, what, -1);
+        if (!tree) continue;
+
+        for (int q = 0; q < CHECK_QUERIES; q++) {
+            point_buffer_clear(b);
+            searchRangeTree(tree, &Ranges[q], point_buffer_add, b);
+            sprintf(what, "searchRangeTree(leaves of %d)", buckets[k]);
+            expect(same_points(b, in_range, q), what, q);
+
+            sprintf(what, "countRangeTree(leaves of %d)", buckets[k]);
+            expect(countRangeTree(tree, &Ranges[q]) == count_in_range(q), what, q);
+        }
+
+        destroyRangeTree(tree);
+    }
+
+    point_buffer_destroy(b);
+    free(pointers);
+}
+
+/**
+ * @brief Function that runs every query on a dynamic kd Tree holding the current points
+ * @param tree the tree
+ * @param name what was done to it
+ * @return -
+*/
+void check_dynamic_queries(DynamicKDTree * tree, const char * name) {
+    char what[128];
+    PointBuffer * b = point_buffer_init(16);
+    Neighbour out[CHECK_K];
+
+    if (!b) exit(1);
+
+    sprintf(what, "%s: count", name);
+    expect(tree->count == N, what, -1);
+
+    for (int q = 0; q < CHECK_QUERIES; q++) {
+        point_buffer_clear(b);
+        searchDynamicKDTree(tree, &Ranges[q], NULL, point_buffer_add, b);
+        sprintf(what, "%s: searchDynamicKDTree()", name);
+        expect(same_points(b, in_range, q), what, q);
+
+        sprintf(what, "%s: countDynamicKDTree()", name);
+        expect(countDynamicKDTree(tree, &Ranges[q], NULL) == count_in_range(q), what, q);
+
+        point_buffer_clear(b);
+        radiusDynamicKDTree(tree, &Centers[q], Radii[q], NULL, point_buffer_add, b);
+        sprintf(what, "%s: radiusDynamicKDTree()", name);
+        expect(same_points(b, in_circle, q), what, q);
+
+        int k = 1 + q % CHECK_K;
+        int found = knnDynamicKDTree(tree, &Centers[q], k, out);
+        sprintf(what, "%s: knnDynamicKDTree()", name);
+        expect(same_neighbours(out, found, &Centers[q], k), what, q);
+    }
+
+    point_buffer_destroy(b);
+}
+
+/**
+ * @brief Function that inserts the points into a dynamic kd Tree, deletes some and inserts some again, checking it after every step
+ * @details Points (and N) follow the tree, so the other checks can be used on it
+ * @return -
+*/
+void check_dynamic(void) {
+    DynamicKDTree * tree = createDynamicKDTree();
+    int n = N;
+    Point * all = (Point *)malloc((n + 1) * sizeof(Point));
+
+    if (!tree || !all) exit(1);
+
+    memcpy(all, Points, n * sizeof(Point));
+
+    for (N = 0; N < n; N++) expect(insertDynamicKDTree(tree, &Points[N]) == 0, "insertDynamicKDTree()", N);
+    check_dynamic_queries(tree, "dynamic, inserted");
+
+    // delete every other point (a copy of it, since the tree has its own), and a point that is not there
+    Point missing;
+    for (int d = 0; d < KD_DIM; d++) missing.c[d] = 1000;
+    expect(deleteDynamicKDTree(tree, &missing) == 0, "deleteDynamicKDTree() of a missing point", -1);
+
+    int kept = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (i % 2 == 0) {
+            Point p = all[i];
+            expect(deleteDynamicKDTree(tree, &p) == 1, "deleteDynamicKDTree()", i);
+        } else {
+            Points[kept++] = all[i];
+        }
+    }
+
+    N = kept;
+    check_dynamic_queries(tree, "dynamic, half deleted");
+
+    // the deleted points again, and more deletes on the way (rebuilds the forest)
+    for (int i = 0; i < n; i += 2) {
+        expect(insertDynamicKDTree(tree, &all[i]) == 0, "insertDynamicKDTree() again", i);
+        Points[N++] = all[i];
+
+        if (i % 6 == 0 && N > 1) {
+            Point p = Points[0];
+            expect(deleteDynamicKDTree(tree, &p) == 1, "deleteDynamicKDTree() while inserting", i);
+            Points[0] = Points[--N];
+        }
+    }
+
+    check_dynamic_queries(tree, "dynamic, mixed");
+
+    // everything out
+    int left = N, deleted = 0;
+
+    while (N > 0) {
+        Point p = Points[--N];
+        deleted += deleteDynamicKDTree(tree, &p);
+    }
+
+    expect(deleted == left && tree->count == 0, "dynamic, all deleted", -1);
+    check_dynamic_queries(tree, "dynamic, empty");
+
+    memcpy(Points, all, n * sizeof(Point));
+    N = n;
+
+    free(all);
+    destroyDynamicKDTree(tree);
+}
+
+/**
+ * @brief Function that checks a point set loaded from a file against the points written to it
+ * @param set the set loaded, NULL if it could not be
+ * @param name how it was loaded
+ * @return -
+*/
+void check_loaded(PointSet * set, const char * name) {
+    expect(set != NULL && set->n == N, name, -1);
+    if (!set || set->n != N) {
+        point_set_destroy(set);
+        return;
+    }
+
+    int same = 1;
+
+    for (int i = 0; i < N; i++) same = same && set->points[i] == &set->data[i] && point_equal(&set->data[i], &Points[i]);
+
+    for (int d = 0; d < KD_DIM; d++) same = same && set->bounds.b[d][0] == Bounds.b[d][0] && set->bounds.b[d][1] == Bounds.b[d][1];
+
+    expect(same, name, -1);
+    point_set_destroy(set);
+}
+
+/**
+ * @brief Function that writes the points to a CSV and a binary file and loads them back, read and mapped
+ * @return -
+*/
+void check_point_set(void) {
+    FILE * csv = fopen(CHECK_CSV, "w");
+    FILE * bin = fopen(CHECK_BIN, "wb");
+
+    if (!csv || !bin) {
+        expect(0, "writing the point files", -1);
+        if (csv) fclose(csv);
+        if (bin) fclose(bin);
+        return;
+    }
+
+    // a header, a comment and an empty line, all skipped; %.17g gives back the same double
+    fprintf(csv, "x,y\n# points of check.c\n\n");
+
+    for (int i = 0; i < N; i++)
+        for (int d = 0; d < KD_DIM; d++) fprintf(csv, "%.17g%s", Points[i].c[d], (d + 1 < KD_DIM) ? ", " : "\n");
+
+    fwrite(Points, sizeof(Point), N, bin);
+
+    fclose(csv);
+    fclose(bin);
+
+    check_loaded(point_set_load(CHECK_CSV, 0), "point_set_load() of a CSV file");
+    check_loaded(point_set_load(CHECK_CSV, 1), "point_set_load() of a mapped CSV file");
+    check_loaded(point_set_load(CHECK_BIN, 0), "point_set_load() of a binary file");
+    check_loaded(point_set_load(CHECK_BIN, 1), "point_set_load() of a mapped binary file");
+
+    unlink(CHECK_CSV);
+    unlink(CHECK_BIN);
+}
+
+/**
+ * @brief Function that makes a set of points and the queries on them, then runs every check
+ * @param n the number of points
+ * @param grid 0 for random coordinates, otherwise integer coordinates in [0, grid)
+ * @return -
+*/
+void check_set(int n, int grid) {
+    N = n;
+    Points = (Point *)malloc((n + 1) * sizeof(Point));
+    Point ** pointers = (Point **)malloc((n + 1) * sizeof(Point *));
+    if (!Points || !pointers) exit(1);
+
+    // random points reach outside the plane, so a region that is too small would be found out
+    for (int i = 0; i < n; i++)
+        for (int d = 0; d < KD_DIM; d++)
+            Points[i].c[d] = grid ? rand() % grid : random_in(-20, 35);
+
+    // the bounding box of the points is the region of the root
+    for (int i = 0; i < n; i++) pointers[i] = &Points[i];
+    Bounds = range_bounding(pointers, n);
+    free(pointers);
+
+    for (int q = 0; q < CHECK_QUERIES; q++) {
+        for (int d = 0; d < KD_DIM; d++) {
+            double lo = grid ? rand() % (grid + 2) - 1 : random_in(-25, 40);
+            double side = grid ? rand() % (grid / 2 + 1) : random_in(0, 30);
+
+            // the first few queries cover everything, and some are flat on an axis
+            if (q < 2) lo = -1000, side = 3000;
+            if (q % 7 == 3) side = 0;
+
+            Ranges[q].b[d][0] = lo;
+            Ranges[q].b[d][1] = lo + side;
+
+            Centers[q].c[d] = grid ? rand() % grid : random_in(-25, 40);
+        }
+
+        Radii[q] = grid ? rand() % grid : random_in(0, 20);
+    }
+
+    check_point_set();
+    check_curves();
+    check_builds();
+    check_flat();
+    check_range_tree();
+
+    // last, it changes Points while it runs
+    check_dynamic();
+
+    free(Points);
+}
+
+int main(int argc, char ** argv) {
+    srand((argc > 1) ? atoi(argv[1]) : 1);
+
+    static const int sizes[] = { 1, 2, 3, 8, 65, 500, 3000 };
+
+    for (int s = 0; s < 7; s++) {
+        check_set(sizes[s], 0);
+        check_set(sizes[s], 5);
+    }
+
+    printf("D=%d: %d checks, %d failed\n", KD_DIM, Checks, Failed);
+
+    return Failed > 0;
+}
+
+#endif
@@ -14,8 +14,13 @@
 #include <stdio.h>
 // for function ceil
 #include <math.h>
+// for memcpy
+#include <string.h>
+// for comparing addresses
+#include <stdint.h>
 // all implemented header files in this directory
 #include "kdTreeInterface.h"
+#include "SpaceCurveInterface.h"
 #include "PointInterface.h"
 #include "RangeInterface.h"
 #include "ListInterface.h"
@@ -50,6 +55,105 @@ void printVisualTree(KDNode * node, int level, const char * prefix) {
     }
 }
 
+/**
+ * @brief Function to report all points in a subtree to a sink
+ * @param node The root of the subtree
+ * @param sink Function called for every point
+ * @param context Passed on to sink
+ * @return -
+*/
+void ReportSubtreeSink(KDNode * node, PointSink sink, void * context) {
+    // a count of 0 is a subtree whose points have all been deleted (see DynamicKDTreeImplementation.c)
+    if (node != NULL && node->count > 0) {
+        if (node->type == LEAF_NODE) {
+            sink(node->point, context);
+        } else if (node->point && node->count == node->end - node->begin) {
+            // nothing deleted: the points are one slice of the tree's array, no need to walk the subtree
+            for (int i = 0; i < node->count; i++) sink(&node->point[i], context);
+        } else {
+            ReportSubtreeSink(node->left, sink, context);
+            ReportSubtreeSink(node->right, sink, context);
+        }
+    }
+}
+
+/**
+ * @brief Function to copy the points of the leaves into one array, in the order of the leaves,
+ * and set the slice [begin, end) of every node
+ * @param node the root of the subtree
+ * @param points the array
+ * @param begin the position of the first point of the subtree
+ * @return the position after the last point of the subtree
+*/
+int layout_leaves(KDNode * node, Point * points, int begin) {
+    if (!node) return begin;
+
+    node->begin = begin;
+
+    if (node->type == LEAF_NODE) {
+        // the leaf's own copy is not needed any more
+        points[begin] = *node->point;
+        free(node->point);
+        node->end = begin + 1;
+    } else {
+        node->end = layout_leaves(node->right, points, layout_leaves(node->left, points, begin));
+    }
+
+    node->point = &points[begin];
+
+    return node->end;
+}
+
+/**
+ * @brief Function to give a built tree one array with the points of its leaves (see KDNode)
+ * @details so a subtree is reported as a slice by ReportSubtreeSink(), and nearby leaves have
+ * their points next to each other. If the array cannot be allocated the tree keeps the points
+ * of its leaves and is walked as before
+ * @param root the root of the tree (its count is the number of leaves)
+ * @return root
+*/
+KDNode * leaf_order(KDNode * root) {
+    if (!root || root->type == LEAF_NODE) return root;
+
+    Point * points = (Point *)malloc(root->count * sizeof(Point));
+
+    if (!points) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return root;
+    }
+
+    layout_leaves(root, points, 0);
+
+    return root;
+}
+
+/**
+ * @brief Function to free the nodes of a tree
+ * @param node the root of the subtree
+ * @param points 1 to free the points of the leaves too (a tree without an array of its points)
+ * @return -
+*/
+void destroy_nodes(KDNode * node, int points) {
+    if (node == NULL) return;
+
+    destroy_nodes(node->left, points);
+    destroy_nodes(node->right, points);
+
+    if (points && node->type == LEAF_NODE && node->point != NULL) free(node->point);
+
+    free(node);
+}
+
+/**
+ * @brief PointSink that adds a copy of the point to a List
+ * @param p The point
+ * @param l The List
+ * @return -
+*/
+void list_sink(Point * p, void * l) {
+    AddFirst((List)l, p);
+}
+
 /**
  * @brief Function to report all points in a subtree
  * @param node The root of the subtree
@@ -57,17 +161,382 @@ void printVisualTree(KDNode * node, int level, const char * prefix) {
  * @return -
 */
 void ReportSubtree(KDNode * node, List l) {
-    if (node != NULL) {
-        // Print indentation and node value
-        if (node->type == LEAF_NODE) {
-            AddFirst(l, node->point);
+    ReportSubtreeSink(node, list_sink, l);
+}
+
+/**
+ * @brief Function to compare two points on the axis of a level, then on the other axes in order, then their address
+ * @details on the x-axis it is the same order as point_compare_x() (and point_compare_y() on the y-axis),
+ * but two different Point objects are never equal, so every subset is split in exactly the same two halves by every build mode
+ * @param a first point
+ * @param b second point
+ * @param axis the axis of the level (depth % KD_DIM)
+ * @return -1: a comes first, 1: b comes first, 0: a and b are the same object
+*/
+int point_order(const Point * a, const Point * b, int axis) {
+    if (a->c[axis] != b->c[axis]) return (a->c[axis] < b->c[axis]) ? -1 : 1;
+
+#define ORDER_ON(i) if (i != axis && a->c[i] != b->c[i]) return (a->c[i] < b->c[i]) ? -1 : 1;
+    KD_EACH(ORDER_ON)
+#undef ORDER_ON
+
+    if (a != b) return ((uintptr_t)a < (uintptr_t)b) ? -1 : 1;
+    return 0;
+}
+
+// qsort() comparators for the order above, one for every axis
+#define ORDER_QSORT(i) \
+    int point_order_qsort_##i(const void * a, const void * b) { \
+        return point_order(*(Point * const *)a, *(Point * const *)b, i); \
+    }
+KD_EACH(ORDER_QSORT)
+#undef ORDER_QSORT
+
+#define ORDER_QSORT_NAME(i) point_order_qsort_##i,
+PointComparator point_order_qsort[KD_DIM] = { KD_EACH(ORDER_QSORT_NAME) };
+#undef ORDER_QSORT_NAME
+
+/**
+ * @brief Function to move the k-th point (0-based) of an array to position k, smaller points before it and larger after it
+ * @details introselect: quickselect with a median of three pivot, that falls back to
+ * sorting if it has taken too many rounds, so it is linear on average and never worse than O(n log n)
+ * @param points the array
+ * @param n the number of points
+ * @param k the position
+ * @param axis the axis to compare on
+ * @return -
+*/
+void select_point(Point ** points, int n, int k, int axis) {
+    int lo = 0, hi = n - 1;
+
+    // about 2 log2(n) rounds before giving up on the pivots
+    int rounds = 2;
+    for (int size = n; size > 1; size /= 2) rounds += 2;
+
+    while (hi > lo) {
+        if (rounds-- == 0) {
+            qsort(points + lo, hi - lo + 1, sizeof(Point *), point_order_qsort[axis]);
+            return;
+        }
+
+        // median of the first, middle and last points as the pivot
+        Point * a = points[lo];
+        Point * b = points[lo + (hi - lo) / 2];
+        Point * c = points[hi];
+        Point * pivot;
+
+        if (point_order(a, b, axis) < 0) {
+            pivot = (point_order(b, c, axis) < 0) ? b : ((point_order(a, c, axis) < 0) ? c : a);
         } else {
-            ReportSubtree(node->left, l);
-            ReportSubtree(node->right, l);
+            pivot = (point_order(a, c, axis) < 0) ? a : ((point_order(b, c, axis) < 0) ? c : b);
         }
+
+        // smaller points to the left of the pivot, larger to the right
+        int i = lo, j = hi;
+
+        while (i <= j) {
+            while (point_order(points[i], pivot, axis) < 0) i++;
+            while (point_order(points[j], pivot, axis) > 0) j--;
+
+            if (i <= j) {
+                Point * t = points[i];
+                points[i] = points[j];
+                points[j] = t;
+                i++;
+                j--;
+            }
+        }
+
+        // continue only with the side that has position k
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else return;
     }
 }
 
+/**
+ * @brief Function to build a KDTree by selecting the median (instead of sorting) at every level
+ * @param points the points of the subtree, reordered
+ * @param n the number of points
+ * @param depth depth of the current level
+ * @return A pointer to the KDTree created
+*/
+KDNode * build_selected(Point ** points, int n, int depth) {
+    if (n <= 0) return NULL;
+
+    if (n == 1) return kdnode_init(points[0], 0, LEAF_NODE);
+
+    int axis = depth % KD_DIM;
+
+    // same median as buildKDTree(): the ceil(n/2)-th point
+    int med = (n + 1) / 2 - 1;
+
+    select_point(points, n, med, axis);
+
+    KDNode * v = kdnode_init(NULL, points[med]->c[axis], (NodeType)axis);
+    if (!v) return NULL;
+
+    v->count = n;
+    v->left = build_selected(points, med + 1, depth + 1);
+    v->right = build_selected(points + med + 1, n - med - 1, depth + 1);
+
+    return v;
+}
+
+/**
+ * @brief Function to build a KDTree from KD_DIM copies of the points, one sorted on every axis
+ * @details the list sorted on the axis of the level is split at the median; the other lists are
+ * split in the same two halves in one pass each, keeping both halves sorted, so every level takes linear time
+ * @param sorted sorted[i]: the points of the subtree sorted by point_order() on axis i
+ * @param scratch space for n points
+ * @param n the number of points
+ * @param depth depth of the current level
+ * @return A pointer to the KDTree created
+*/
+KDNode * build_presorted(Point *** sorted, Point ** scratch, int n, int depth) {
+    if (n <= 0) return NULL;
+
+    if (n == 1) return kdnode_init(sorted[0][0], 0, LEAF_NODE);
+
+    int axis = depth % KD_DIM;
+
+    int med = (n + 1) / 2 - 1;
+    Point * median = sorted[axis][med];
+
+    KDNode * v = kdnode_init(NULL, median->c[axis], (NodeType)axis);
+    if (!v) return NULL;
+
+    // in the lists of the other axes the points up to the median go left, keeping their order
+    for (int d = 0; d < KD_DIM; d++) {
+        if (d == axis) continue;
+
+        Point ** b = sorted[d];
+        int left = 0, right = med + 1;
+
+        for (int i = 0; i < n; i++) {
+            if (point_order(b[i], median, axis) <= 0) scratch[left++] = b[i];
+            else scratch[right++] = b[i];
+        }
+
+        memcpy(b, scratch, n * sizeof(Point *));
+    }
+
+    // the right halves of the lists
+    Point ** upper[KD_DIM];
+    for (int d = 0; d < KD_DIM; d++) upper[d] = sorted[d] + med + 1;
+
+    v->count = n;
+    v->left = build_presorted(sorted, scratch, med + 1, depth + 1);
+    v->right = build_presorted(upper, scratch, n - med - 1, depth + 1);
+
+    return v;
+}
+
+/**
+ * @brief Function to restore the max-heap of candidates (largest distance on top) after heap[i] grew
+ * @param heap the candidates
+ * @param i the position that changed
+ * @return -
+*/
+void neighbour_sift_up(Neighbour * heap, int i) {
+    Neighbour moved = heap[i];
+
+    while (i > 0 && heap[(i - 1) / 2].distance < moved.distance) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+
+    heap[i] = moved;
+}
+
+/**
+ * @brief Function to restore the max-heap of candidates after heap[i] shrank
+ * @param heap the candidates
+ * @param n the number of candidates
+ * @param i the position that changed
+ * @return -
+*/
+void neighbour_sift_down(Neighbour * heap, int n, int i) {
+    Neighbour moved = heap[i];
+
+    while (2 * i + 1 < n) {
+        int child = 2 * i + 1;
+        if (child + 1 < n && heap[child + 1].distance > heap[child].distance) child++;
+
+        if (heap[child].distance <= moved.distance) break;
+
+        heap[i] = heap[child];
+        i = child;
+    }
+
+    heap[i] = moved;
+}
+
+/**
+ * @brief Function to compute the squared distance between two points
+ * @param a first point
+ * @param b second point
+ * @return the squared distance
+*/
+double distance_squared(const Point * a, const Point * b) {
+    double sum = 0;
+
+#define DISTANCE_ON(i) { double d = a->c[i] - b->c[i]; sum += d * d; }
+    KD_EACH(DISTANCE_ON)
+#undef DISTANCE_ON
+
+    return sum;
+}
+
+/**
+ * @brief Function to search a subtree for points closer to the query than the worst candidate
+ * @details the near child is searched first. The far child is only searched if its region
+ * is closer than the worst candidate. 'offset' holds, for each axis, how far the query is
+ * from the region of the current node (0 inside it), so the squared distance of a child's
+ * region is found by replacing one of them
+ * @param node the root of the subtree
+ * @param query the query point
+ * @param offset distance from the query to the region of the node, on every axis
+ * @param region_distance squared distance from the query to the region of the node
+ * @param k the number of neighbours wanted
+ * @param heap max-heap of the candidates found so far, by squared distance
+ * @param size the number of candidates in heap
+ * @return -
+*/
+void knn_search(KDNode * node, Point * query, double offset[KD_DIM], double region_distance, int k, Neighbour * heap, int * size) {
+    // nothing left in this subtree (deleted points)
+    if (node->count == 0) return;
+
+    if (node->type == LEAF_NODE) {
+        double distance = distance_squared(node->point, query);
+
+        if (*size < k) {
+            heap[*size].point = node->point;
+            heap[*size].distance = distance;
+            neighbour_sift_up(heap, (*size)++);
+        } else if (distance < heap[0].distance) {
+            heap[0].point = node->point;
+            heap[0].distance = distance;
+            neighbour_sift_down(heap, k, 0);
+        }
+        return;
+    }
+
+    int axis = node->type;
+    double diff = query->c[axis] - node->line;
+
+    // the left child has the points up to the line, the right one the points from it
+    KDNode * near = (diff <= 0) ? node->left : node->right;
+    KDNode * far = (diff <= 0) ? node->right : node->left;
+
+    knn_search(near, query, offset, region_distance, k, heap, size);
+
+    double old = offset[axis];
+    double far_distance = region_distance - old * old + diff * diff;
+
+    if (*size < k || far_distance < heap[0].distance) {
+        offset[axis] = diff;
+        knn_search(far, query, offset, far_distance, k, heap, size);
+        offset[axis] = old;
+    }
+}
+
+/**
+ * @brief Function to turn the max-heap of candidates into the answer: closest first, with real distances
+ * @param heap the candidates, by squared distance
+ * @param size the number of candidates
+ * @return -
+*/
+void knn_finish(Neighbour * heap, int size) {
+    // heap sort: move the farthest candidate to the end, one at a time
+    for (int end = size - 1; end > 0; end--) {
+        Neighbour farthest = heap[0];
+        heap[0] = heap[end];
+        heap[end] = farthest;
+        neighbour_sift_down(heap, end, 0);
+    }
+
+    for (int i = 0; i < size; i++) heap[i].distance = sqrt(heap[i].distance);
+}
+
+/**
+ * @brief Function that spreads the 16 low bits of x to the even bits of the result
+ * @param x the bits
+ * @return the spread bits
+*/
+uint32_t spread_bits(uint32_t x) {
+    x &= 0xffff;
+    x = (x | (x << 8)) & 0x00ff00ff;
+    x = (x | (x << 4)) & 0x0f0f0f0f;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+// A query of a batch and its place on the Z-order curve
+typedef struct query_order {
+    uint32_t key;
+    int index;
+} QueryOrder;
+
+/**
+ * @brief Function to compare two queries on the Z-order curve, for qsort()
+ * @return the order of a and b
+*/
+int query_order_compare(const void * a, const void * b) {
+    uint32_t x = ((const QueryOrder *)a)->key;
+    uint32_t y = ((const QueryOrder *)b)->key;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Function to sort a batch of queries in Z-order, so that nearby queries are next to each other
+ * @details the bounding box of the points is divided in 2^16 x 2^16 cells, and the key of a point
+ * interleaves the bits of its cell's column and row
+ * @param points the position of every query
+ * @param count the number of queries
+ * @return the indices of the queries in Z-order (to be freed by the caller), NULL if allocation failed
+*/
+int * z_order(Point * points, int count) {
+    QueryOrder * order = (QueryOrder *)malloc(count * sizeof(QueryOrder));
+    int * indices = (int *)malloc(count * sizeof(int));
+
+    if (!order || !indices) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        free(order);
+        free(indices);
+        return NULL;
+    }
+
+    double xmin = points[0].x, xmax = points[0].x, ymin = points[0].y, ymax = points[0].y;
+
+    for (int i = 1; i < count; i++) {
+        if (points[i].x < xmin) xmin = points[i].x;
+        if (points[i].x > xmax) xmax = points[i].x;
+        if (points[i].y < ymin) ymin = points[i].y;
+        if (points[i].y > ymax) ymax = points[i].y;
+    }
+
+    double xscale = (xmax > xmin) ? 65535 / (xmax - xmin) : 0;
+    double yscale = (ymax > ymin) ? 65535 / (ymax - ymin) : 0;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t cx = (uint32_t)((points[i].x - xmin) * xscale);
+        uint32_t cy = (uint32_t)((points[i].y - ymin) * yscale);
+
+        order[i].key = spread_bits(cx) | (spread_bits(cy) << 1);
+        order[i].index = i;
+    }
+
+    qsort(order, count, sizeof(QueryOrder), query_order_compare);
+
+    for (int i = 0; i < count; i++) indices[i] = order[i].index;
+
+    free(order);
+
+    return indices;
+}
+
 /* ------------------------------ CORE FUNCTIONS ------------------------------ */
 
 /**
@@ -95,7 +564,7 @@ KDNode * kdnode_init(Point * p, double line, NodeType type) {
         // set to EMPTY the line field
         // NewNode->point->x = p->x;
         // NewNode->point->y = p->y;
-        NewNode->point = point_init(p->x, p->y);
+        NewNode->point = point_init_coords(p->c);
 
         if (!NewNode->point) {
             free(NewNode);
@@ -111,6 +580,13 @@ KDNode * kdnode_init(Point * p, double line, NodeType type) {
         NewNode->line = line;
     }
 
+    // a leaf holds one point, the builders set the count of the other nodes
+    NewNode->count = (type == LEAF_NODE) ? 1 : 0;
+
+    // set by leaf_order() when the tree is built
+    NewNode->begin = 0;
+    NewNode->end = NewNode->count;
+
     // finally, init the pointer to children fields
     NewNode->left = NULL;
     NewNode->right = NULL;
@@ -160,7 +636,9 @@ KDNode * buildKDTree(Point ** points, int n, int depth) {
 
 
     // sort the points in the current subset based on the depth
-    qsort(points, n, sizeof(Point *), (depth % 2) ? point_compare_y : point_compare_x);
+    int axis = depth % KD_DIM;
+
+    qsort(points, n, sizeof(Point *), point_order_qsort[axis]);
 
 
     int med = (int)ceil((n)/2.0);
@@ -168,79 +646,316 @@ KDNode * buildKDTree(Point ** points, int n, int depth) {
     // reduce this by 1 because of the 0-based index
     med--;
         
-    NodeType type = (!(depth % 2)) ? VERTICAL_LINE : HORIZONTAL_LINE;
+    // the type of an internal node is the axis of its line
+    NodeType type = (NodeType)axis;
+
+    KDNode * v = kdnode_init(NULL, points[med]->c[axis], type);
+
+    // all the points of this subset end up under v
+    v->count = n;
 
-    KDNode * v = kdnode_init(NULL, (depth % 2) ? points[med]->y : points[med]->x, type);
-    
     // create the children
     
     v->left = buildKDTree(points, med + 1, depth + 1);
 
     v->right = buildKDTree(points + med + 1, (n - med - 1 == 0) ? 1 :  n - med - 1, depth + 1);
 
-    return v;
+    // once the whole tree is built, its points go into one array
+    return (depth == 0) ? leaf_order(v) : v;
 
 }
 
 /**
- * @brief Function search for points inside a given range
- * @note Used the List code from hw0 of this course.
- * @note Pass the list as a pointer to the function for recursive calls and do not create a new one with each call.
+ * @brief Function to build a KDTree, choosing how the median is found at every level
+ * @details every mode gives the same tree as buildKDTree(). The points must be different
+ * Point objects (they may have the same coordinates).
+ * @param points the set of points, may be reordered (BUILD_QSORT, BUILD_SELECT, BUILD_CURVE)
+ * @param n the number of points in 'points'
+ * @param mode BUILD_QSORT, BUILD_PRESORT, BUILD_SELECT or BUILD_CURVE
+ * @return A pointer to the KDTree created
+*/
+KDNode * buildKDTreeWith(Point ** points, int n, BuildMode mode) {
+    if (!points || n <= 0) return NULL;
+
+    if (mode == BUILD_QSORT) return buildKDTree(points, n, 0);
+
+    if (mode == BUILD_SELECT) return leaf_order(build_selected(points, n, 0));
+
+    if (mode == BUILD_CURVE) {
+        // the subsets split by the build are boxes, and in Morton order a box is a few runs
+        // of the array, so the points of a subset are close in memory and the deeper levels
+        // work in the cache. The copies are only read by the build (the leaves get their own),
+        // so they are made for a copy of the pointers and freed after
+        Point ** order = (Point **)malloc(n * sizeof(Point *));
+
+        if (!order) {
+            fprintf(stderr, "Unable to allocate memory.\n");
+            return NULL;
+        }
+
+        memcpy(order, points, n * sizeof(Point *));
+        Point * layout = layoutPointsCurve(order, n, CURVE_MORTON);
+
+        // without the copies the points are built where they are
+        KDNode * root = leaf_order(build_selected(layout ? order : points, n, 0));
+
+        free(layout);
+        free(order);
+
+        return root;
+    }
+
+    // BUILD_PRESORT: one list sorted on every axis and room to split them
+    Point ** sorted[KD_DIM];
+    Point ** scratch = (Point **)malloc(n * sizeof(Point *));
+    int ok = (scratch != NULL);
+
+    for (int d = 0; d < KD_DIM; d++) {
+        sorted[d] = (Point **)malloc(n * sizeof(Point *));
+        if (!sorted[d]) ok = 0;
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        for (int d = 0; d < KD_DIM; d++) free(sorted[d]);
+        free(scratch);
+        return NULL;
+    }
+
+    for (int d = 0; d < KD_DIM; d++) {
+        memcpy(sorted[d], points, n * sizeof(Point *));
+        qsort(sorted[d], n, sizeof(Point *), point_order_qsort[d]);
+    }
+
+    KDNode * root = leaf_order(build_presorted(sorted, scratch, n, 0));
+
+    for (int d = 0; d < KD_DIM; d++) free(sorted[d]);
+    free(scratch);
+
+    return root;
+}
+
+/**
+ * @brief Function search for points inside a given range and report them to a sink
+ * @details the points are not copied: the sink gets the points stored in the leaves
  * @param root The tree’s root
  * @param range The query range
- * @param region the region of the current node
- * @param l List to store the results
+ * @param region the region of the current node (NULL for all of space, at the root)
+ * @param sink Function called for every point inside the range
+ * @param context Passed on to sink (i.e. where to store the results)
  * @return -
 */
-void searchKDTree(KDNode * root, Range * range, Range * region, List l) {
-    if (!l || !root) return;
+void searchKDTreeSink(KDNode * root, Range * range, Range * region, PointSink sink, void * context) {
+    if (!sink || !root || root->count == 0) return;
+
+    // NULL stands for all of space, so points outside the plane are found too
+    Range everything;
+
+    if (!region) {
+        everything = range_infinite();
+        region = &everything;
+    }
 
     if (root->type == LEAF_NODE) {
         // check if the point is inside the range
-        // and if yes, add it to the list
+        // and if yes, report it
         if (point_in_range(root->point, range)) {
-            AddFirst(l, root->point);
+            sink(root->point, context);
         }
         return;
     } else {
-        // check if the region(lc(v)) is fully contained in the range
-        
-        Range * lc_region = (root->type == VERTICAL_LINE) ? intersect_square_on_x_left(region, root->line) : intersect_square_on_y_down(region, root->line);
-
-        if (!lc_region) return;
+        // the regions of the children are computed on the stack,
+        // so the search itself doesn't allocate any memory
 
+        // check if the region(lc(v)) is fully contained in the range
+        Range lc_region = region_below(region, root->type, root->line);
 
-        if (range_contains(range, lc_region)) {
+        if (range_contains(range, &lc_region)) {
             // use this helper function to report all the point in lc_region
-            ReportSubtree(root->left, l);
-        } else if (range_intersect(range, lc_region)) {
+            ReportSubtreeSink(root->left, sink, context);
+        } else if (range_intersect(range, &lc_region)) {
             // check if the point is inside the range
-            // and if yes, add it to the list
-            searchKDTree(root->left, range, lc_region, l);
+            // and if yes, report it
+            searchKDTreeSink(root->left, range, &lc_region, sink, context);
         }
 
 
-        Range * rc_region = (root->type == VERTICAL_LINE) ? intersect_square_on_x_right(region, root->line) : intersect_square_on_y_up(region, root->line);
-        if (!rc_region) return;
+        Range rc_region = region_above(region, root->type, root->line);
 
-
-        if (range_contains(range, rc_region)) {
+        if (range_contains(range, &rc_region)) {
             // use this helper function to report all the point in ρc_region
-            ReportSubtree(root->right, l);
-        } else if (range_intersect(range, rc_region)) {
+            ReportSubtreeSink(root->right, sink, context);
+        } else if (range_intersect(range, &rc_region)) {
             // check if the point is inside the range
-            // and if yes, add it to the list
-            searchKDTree(root->right, range, rc_region, l);
+            // and if yes, report it
+            searchKDTreeSink(root->right, range, &rc_region, sink, context);
         }
+    }
+}
+
+/**
+ * @brief Function search for points within a distance of a center and report them to a sink
+ * @details a subtree whose region is farther than the radius is skipped, and one whose
+ * region is entirely inside the circle is reported without checking its points
+ * @param root The tree’s root
+ * @param center The center of the circle
+ * @param radius The radius of the circle (points at exactly this distance are inside)
+ * @param region the region of the current node (NULL for all of space, at the root)
+ * @param sink Function called for every point inside the circle
+ * @param context Passed on to sink
+ * @return -
+*/
+void radiusKDTree(KDNode * root, Point * center, double radius, Range * region, PointSink sink, void * context) {
+    if (!sink || !root || root->count == 0 || !center || radius < 0) return;
+
+    // NULL stands for all of space, so points outside the plane are found too
+    Range everything;
+
+    if (!region) {
+        everything = range_infinite();
+        region = &everything;
+    }
+
+    double limit = radius * radius;
+
+    if (root->type == LEAF_NODE) {
+        if (distance_squared(root->point, center) <= limit) sink(root->point, context);
+        return;
+    }
+
+    Range lc_region = region_below(region, root->type, root->line);
+
+    if (range_max_distance(&lc_region, center) <= limit) {
+        ReportSubtreeSink(root->left, sink, context);
+    } else if (range_min_distance(&lc_region, center) <= limit) {
+        radiusKDTree(root->left, center, radius, &lc_region, sink, context);
+    }
+
+    Range rc_region = region_above(region, root->type, root->line);
+
+    if (range_max_distance(&rc_region, center) <= limit) {
+        ReportSubtreeSink(root->right, sink, context);
+    } else if (range_min_distance(&rc_region, center) <= limit) {
+        radiusKDTree(root->right, center, radius, &rc_region, sink, context);
+    }
+}
+
+/**
+ * @brief Function to count the points inside a given range, without reporting them
+ * @details same walk as searchKDTreeSink(), but a region fully inside the range adds
+ * the count stored in its node instead of visiting its points, so the query takes
+ * O(sqrt(n)) and allocates nothing
+ * @param root The tree’s root
+ * @param range The query range
+ * @param region the region of the current node (NULL for all of space, at the root)
+ * @return the number of points inside the range
+*/
+int countKDTree(KDNode * root, Range * range, Range * region) {
+    if (!root || !range || root->count == 0) return 0;
+
+    // NULL stands for all of space, so points outside the plane are found too
+    Range everything;
+
+    if (!region) {
+        everything = range_infinite();
+        region = &everything;
+    }
+
+    if (root->type == LEAF_NODE) return point_in_range(root->point, range);
+
+    int count = 0;
+
+    Range lc_region = region_below(region, root->type, root->line);
+
+    if (range_contains(range, &lc_region)) {
+        count += root->left->count;
+    } else if (range_intersect(range, &lc_region)) {
+        count += countKDTree(root->left, range, &lc_region);
+    }
+
+    Range rc_region = region_above(region, root->type, root->line);
+
+    if (range_contains(range, &rc_region)) {
+        count += root->right->count;
+    } else if (range_intersect(range, &rc_region)) {
+        count += countKDTree(root->right, range, &rc_region);
+    }
+
+    return count;
+}
+
+/**
+ * @brief Function search for points inside a given range
+ * @note Used the List code from hw0 of this course.
+ * @note Pass the list as a pointer to the function for recursive calls and do not create a new one with each call.
+ * @param root The tree’s root
+ * @param range The query range
+ * @param region the region of the current node (NULL for all of space, at the root)
+ * @param l List to store the results (every point is copied into it)
+ * @return -
+*/
+void searchKDTree(KDNode * root, Range * range, Range * region, List l) {
+    if (!l) return;
+
+    searchKDTreeSink(root, range, region, list_sink, l);
+}
+
+/**
+ * @brief Function to find the k points of the tree closest to a query point
+ * @details depth-first branch and bound: 'out' is used as a max-heap of the best k
+ * candidates, and a subtree whose region is farther than the worst of them is skipped
+ * @param root The tree’s root
+ * @param query The query point
+ * @param k The number of neighbours wanted
+ * @param out Room for k neighbours, filled closest first (the points are the ones stored in the tree)
+ * @return the number of neighbours found (k, or the number of points if there are fewer)
+*/
+int knnKDTree(KDNode * root, Point * query, int k, Neighbour * out) {
+    if (!root || !query || !out || k <= 0) return 0;
+
+    double offset[KD_DIM] = { 0 };
+    int size = 0;
+
+    knn_search(root, query, offset, 0, k, out, &size);
+    knn_finish(out, size);
+
+    return size;
+}
 
-        // free the regions
-        free(lc_region);
-        free(rc_region);
+/**
+ * @brief Function to answer many k nearest neighbour queries at once
+ * @details the queries are answered in Z-order (nearby queries one after the other),
+ * so they walk mostly the same parts of the tree while they are still in the cache
+ * @param root The tree’s root
+ * @param queries The query points
+ * @param count The number of queries
+ * @param k The number of neighbours wanted for each query
+ * @param out Room for count * k neighbours, out[i * k ...] are the ones of queries[i], as in knnKDTree()
+ * @param found found[i] is the number of neighbours found for queries[i]
+ * @return -
+*/
+void knnKDTreeBatch(KDNode * root, Point * queries, int count, int k, Neighbour * out, int * found) {
+    if (!queries || !out || !found || count <= 0) return;
+
+    int * order = z_order(queries, count);
+
+    if (!order) {
+        // still answer them, in the order given
+        for (int i = 0; i < count; i++) found[i] = knnKDTree(root, &queries[i], k, out + (size_t)i * k);
+        return;
     }
+
+    for (int i = 0; i < count; i++) {
+        int q = order[i];
+        found[q] = knnKDTree(root, &queries[q], k, out + (size_t)q * k);
+    }
+
+    free(order);
 }
 
 /**
  * @brief Function to destroy a KDTree
+ * @details only the root of a tree can be destroyed (the nodes below share the array of its points)
  * @param root A pointer to the root of the Tree
  * @return -
 */
@@ -248,23 +963,16 @@ void destroyKDTree(KDNode * root) {
     if (root == NULL) {
         return;
     }
-    
-    // First free children recursively
-    if (root->left != NULL) {
-        destroyKDTree(root->left);
-    }
-    
-    if (root->right != NULL) {
-        destroyKDTree(root->right);
-    }
-    
-    // Then free current node's data
-    if (root->type == LEAF_NODE && root->point != NULL) {
-        free(root->point);
+
+    // a tree with an array of its points (see leaf_order()) frees it once, after the nodes
+    if (root->type != LEAF_NODE && root->point != NULL) {
+        Point * points = root->point;
+        destroy_nodes(root, 0);
+        free(points);
+        return;
     }
-    
-    // Finally free the node itself
-    free(root);
+
+    destroy_nodes(root, 1);
 }
 
 #endif
\ No newline at end of file
@@ -13,14 +13,20 @@
 #include "PointInterface.h"
 #include "RangeInterface.h"
 #include "ListInterface.h"
+#include "PointBufferInterface.h"
 
+// The type of an internal node is the axis of its line (0 ... KD_DIM - 1),
+// so VERTICAL_LINE and HORIZONTAL_LINE are the first two
 typedef enum node_type {
-    VERTICAL_LINE, HORIZONTAL_LINE, LEAF_NODE
+    VERTICAL_LINE, HORIZONTAL_LINE, LEAF_NODE = KD_DIM
 } NodeType;
 
 typedef struct kdnode {
-    // The point stored in this node
-    // only for leaf nodes
+    // The point stored in this node on leaf nodes.
+    // The builders copy the points of the leaves into one array, in the
+    // order of the leaves, so the points of every subtree are a slice of
+    // it: on the other nodes this is the first point of the subtree
+    // (NULL if the array could not be allocated)
     Point * point;
 
     // Value for line - NULL on leaf nodes
@@ -28,22 +34,70 @@ typedef struct kdnode {
 
     // VERTICAL_LINE if Vertical Line (x-axis)
     // HORIZONTAL_LINE if Horizontal Line(y-axis)
+    // 2 ... KD_DIM - 1 for a line on the other axes
     // LEAF_NODE if Leaf Node
     NodeType type;
 
+    // Number of points in this subtree (1 on leaf nodes)
+    int count;
+
+    // The points of this subtree are [begin, end) in the array of the
+    // tree (end - begin is the count when the tree was built)
+    int begin;
+    int end;
+
     struct kdnode * left; // Left subtree
 
     struct kdnode * right; // Right subtree
 } KDNode;
 
+// How buildKDTreeWith() finds the median at every level.
+// All of them give the same tree as buildKDTree().
+typedef enum build_mode {
+    BUILD_QSORT,    // sort the subset at every level (what buildKDTree() does), O(n log^2 n)
+    BUILD_PRESORT,  // sort on every axis once, split all the lists in linear time per level, O(n log n)
+    BUILD_SELECT,   // select the median in expected linear time per level, O(n log n)
+    BUILD_CURVE     // copy the points in Morton order first (layoutPointsCurve()), then as BUILD_SELECT
+} BuildMode;
+
 void printVisualTree(KDNode *, int, const char *);
 
 KDNode * kdnode_init(Point *, double, NodeType);
 
 KDNode * buildKDTree(Point **, int, int);
+
+KDNode * buildKDTreeWith(Point **, int, BuildMode);
+
+// from ParallelBuildImplementation.c
+KDNode * buildKDTreeParallel(Point **, int, int);
    
 void searchKDTree(KDNode *, Range *, Range *, List);
 
+// Called once for every point reported by a query, with the context
+// given to the query. The point is the one stored in the tree (not a copy).
+typedef void (* PointSink)(Point *, void *);
+
+void searchKDTreeSink(KDNode *, Range *, Range *, PointSink, void *);
+
+void ReportSubtreeSink(KDNode *, PointSink, void *);
+
+void radiusKDTree(KDNode *, Point *, double, Range *, PointSink, void *);
+
+int countKDTree(KDNode *, Range *, Range *);
+
+// One result of knnKDTree(): a point stored in the tree and its distance from the query
+typedef struct neighbour {
+    Point * point;
+    double distance;
+} Neighbour;
+
+int knnKDTree(KDNode *, Point *, int, Neighbour *);
+
+void knnKDTreeBatch(KDNode *, Point *, int, int, Neighbour *, int *);
+
+// from ParallelSearchImplementation.c
+int searchKDTreeBatch(KDNode *, Range *, int, Range *, PointBuffer **, int, int);
+
 void destroyKDTree(KDNode *);
 
 #endif
\ No newline at end of file
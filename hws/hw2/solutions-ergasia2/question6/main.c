@@ -11,68 +11,144 @@
 #include <stdlib.h>
 // for stdin, stdout and stderr use
 #include <stdio.h>
+// for the command line arguments
+#include <string.h>
 // all implemented header files in this directory
 #include "kdTreeInterface.h"
 #include "PointInterface.h"
 #include "RangeInterface.h"
 #include "ListInterface.h"
+#include "FlatKDTreeInterface.h"
+#include "PointSetInterface.h"
+
+// points per leaf of a saved tree (the fastest leaf size of bench.c)
+#define SAVED_BUCKET 64
+
+// larger trees are not printed
+#define PRINT_LIMIT 64
+
+// from kdTreeImplementation.c
+void list_sink(Point *, void *);
+
+// usage: ./q6                                asks for the points, builds the tree and answers a range query
+//        ./q6 load <points>                  the same, with the points of a CSV or binary file (see PointSetInterface.h)
+//        ./q6 [load <points>] save <file>    the same, and saves the tree to <file>
+//        ./q6 open <file>                    answers a range query on the tree saved in <file>, without asking for points
+int main (int argc, char ** argv) {
+    const char * load_path = NULL;
+    const char * save_path = NULL;
+    const char * open_path = NULL;
+
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 < argc && strcmp(argv[i], "load") == 0) load_path = argv[i + 1];
+        else if (i + 1 < argc && strcmp(argv[i], "save") == 0) save_path = argv[i + 1];
+        else if (i + 1 < argc && strcmp(argv[i], "open") == 0) open_path = argv[i + 1];
+        else {
+            fprintf(stderr, "usage: %s [load <points>] [save <file>] | %s open <file>\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
 
-int main () {
-    int num;
-    /* ----------------------- ask for amount points ----------------------- */ 
-    printf("\n>>> GIVE NUMBER OF POINTS:\n>>> ");
-    scanf("%d", &num);
+    int num = 0;
+    Point ** points = NULL;
+    PointSet * set = NULL;
+    KDNode * root = NULL;
+    FlatKDTree * saved = NULL;
 
-    if (num <= 0) {
-        fprintf(stderr, "\n>>> INVALID AMOUNT OF POINTS\n");
-        return 1;
-    }
+    // the region of the root: the bounding box of the points, so any coordinates can be given
+    Range plane;
 
-    Point ** points;
-    points = (Point **)malloc(num * sizeof(Point *));
+    /* ----------------------- open a saved tree ----------------------- */ 
 
-    if ( !points) {
-        fprintf(stderr, "Unable to allocate memory.\n");
-        return 1;
-    }
+    if (open_path) {
+        saved = openFlatKDTree(open_path);
+        if (!saved) return 1;
+
+        printf("\n>>> OPENED KD TREE OF %d POINTS\n", saved->n);
+
+        plane = saved->bounds;
+    } else if (load_path) {
+        /* ----------------------- load the points ----------------------- */ 
+
+        set = point_set_load(load_path, 1);
+        if (!set) return 1;
+
+        if (set->n <= 0) {
+            fprintf(stderr, "\n>>> INVALID AMOUNT OF POINTS\n");
+            point_set_destroy(set);
+            return 1;
+        }
+
+        num = set->n;
+        points = set->points;
+
+        printf("\n>>> LOADED %d POINTS FROM %s\n", num, load_path);
+    } else {
+        /* ----------------------- ask for amount points ----------------------- */ 
+        printf("\n>>> GIVE NUMBER OF POINTS:\n>>> ");
+        scanf("%d", &num);
+
+        if (num <= 0) {
+            fprintf(stderr, "\n>>> INVALID AMOUNT OF POINTS\n");
+            return 1;
+        }
+
+        points = (Point **)malloc(num * sizeof(Point *));
+
+        if ( !points) {
+            fprintf(stderr, "Unable to allocate memory.\n");
+            return 1;
+        }
 
     
-    /* ----------------------- ask for the points ----------------------- */ 
+        /* ----------------------- ask for the points ----------------------- */ 
 
-    double x, y;
+        double x, y;
     
-    for (int i = 0; i < num; i++) {
+        for (int i = 0; i < num; i++) {
 
-        printf("\n>>> GIVE COORDINATES:\n");
+            printf("\n>>> GIVE COORDINATES:\n");
 
-        do {
             printf(">>> (x) ");
             scanf("%lf", &x);
-            if (x < PLANE_X_MIN || x > PLANE_X_MAX) fprintf(stderr, "\n>>> INVALID X COORDINATE. INSERT AGAIN\n");
-        } while (x < PLANE_X_MIN || x > PLANE_X_MAX);
-            
-        do {
+
             printf(">>> (y) ");
             scanf("%lf", &y);
-            if (y < PLANE_Y_MIN || y > PLANE_Y_MAX) fprintf(stderr, "\n>>> INVALID Y COORDINATE. INSERT AGAIN\n");
-        } while (y < PLANE_Y_MIN || y > PLANE_Y_MAX);
         
-        points[i] = point_init(x, y);
+            points[i] = point_init(x, y);
+        }
     }
 
-    /* ----------------------- create and build the tree ----------------------- */ 
+    if (!open_path) {
+        /* ----------------------- create and build the tree ----------------------- */ 
 
-    printf("\n>>> BUILDING KD TREE...\n");
+        printf("\n>>> BUILDING KD TREE...\n");
 
-    // create the tree by giving the points, a starting and an ending 
-    // index, and the starting depth, which should always be 0
-    KDNode * root = buildKDTree(points, num, 0);
+        // create the tree by giving the points, a starting and an ending 
+        // index, and the starting depth, which should always be 0
+        root = buildKDTree(points, num, 0);
 
-    if (!root) return 1;
+        if (!root) return 1;
 
-    printf("\n");
+        plane = range_bounding(points, num);
+
+        if (num <= PRINT_LIMIT) {
+            printf("\n");
+
+            printVisualTree(root, 0, "root");
+        }
+
+        /* ----------------------- save the tree ----------------------- */ 
+
+        if (save_path) {
+            FlatKDTree * flat = buildFlatKDTreeBuckets(points, num, SAVED_BUCKET);
+            if (!flat) return 1;
 
-    printVisualTree(root, 0, "root");
+            if (saveFlatKDTree(flat, save_path)) printf("\n>>> SAVED KD TREE TO %s\n", save_path);
+
+            destroyFlatKDTree(flat);
+        }
+    }
 
     /* ----------------------- ask for the range query ----------------------- */ 
     
@@ -82,37 +158,30 @@ int main () {
     do {
         printf(">>> (xmin) ");
         scanf("%lf", &xmin);
-        if (xmin < PLANE_X_MIN || xmin > PLANE_X_MAX) fprintf(stderr, "\n>>> INVALID X-MIN COORDINATE. INSERT AGAIN\n");
-    } while (xmin < PLANE_X_MIN || xmin > PLANE_X_MAX);
 
-    do {
         printf(">>> (xmax) ");
         scanf("%lf", &xmax);
-        if (xmax < PLANE_X_MIN || xmax > PLANE_X_MAX) fprintf(stderr, "\n>>> INVALID X-MAX COORDINATE. INSERT AGAIN\n");
-    } while (xmax < PLANE_X_MIN || xmax > PLANE_X_MAX);
+        if (xmin > xmax) fprintf(stderr, "\n>>> X-MIN IS LARGER THAN X-MAX. INSERT AGAIN\n");
+    } while (xmin > xmax);
 
     do {
         printf(">>> (ymin) ");
         scanf("%lf", &ymin);
-        if (ymin < PLANE_Y_MIN || ymin > PLANE_Y_MAX) fprintf(stderr, "\n>>> INVALID Y-MIN COORDINATE. INSERT AGAIN\n");
-    } while (ymin < PLANE_Y_MIN || ymin > PLANE_Y_MAX);
 
-    do {
         printf(">>> (ymax) ");
         scanf("%lf", &ymax);
-        if (ymax < PLANE_Y_MIN || ymax > PLANE_Y_MAX) fprintf(stderr, "\n>>> INVALID Y-MAX COORDINATE. INSERT AGAIN\n");
-    } while (ymax < PLANE_Y_MIN || ymax > PLANE_Y_MAX);
+        if (ymin > ymax) fprintf(stderr, "\n>>> Y-MIN IS LARGER THAN Y-MAX. INSERT AGAIN\n");
+    } while (ymin > ymax);
     
     // create the range
     Range * range_query = range_init(xmin, xmax, ymin, ymax);
     if (!range_query) return 1;
 
-    // these values have been defines in RangeInterface.h
-    // where 0 <= x, y <= 15. If you want to change the values
-    // of the plane, change them in the header file
-    // and recompile
-    Range * plane = range_init(PLANE_X_MIN, PLANE_X_MAX, PLANE_Y_MIN, PLANE_Y_MAX);
-    if( !plane) return 1;
+    // the coordinates after y (KD_DIM > 2) are not asked, the range covers all the points on them
+    for (int d = 2; d < KD_DIM; d++) {
+        range_query->b[d][0] = plane.b[d][0];
+        range_query->b[d][1] = plane.b[d][1];
+    }
 
     // create the list for the points inside the range query
     List l = Create();
@@ -121,7 +190,8 @@ int main () {
 
     printf("\n>>> SEARCHING FOR POINTS INSIDE THE RANGE QUERY...\n");
 
-    searchKDTree(root, range_query, plane, l);
+    if (saved) searchFlatKDTree(saved, range_query, &plane, list_sink, l);
+    else searchKDTree(root, range_query, &plane, l);
 
     printf("\n");
 
@@ -132,18 +202,22 @@ int main () {
 
     FreeList(l);
 
-    free(plane);
     free(range_query);
 
     destroyKDTree(root);
+    destroyFlatKDTree(saved);
 
     // free the memory allocated for the points
-    for (int i = num - 1; i >= 0; i--) {
-        free(points[i]);
+    if (set) {
+        point_set_destroy(set);
+    } else {
+        for (int i = num - 1; i >= 0; i--) {
+            free(points[i]);
+        }
+
+        free(points);
     }
 
-    free(points);
-
     return 0;
 }
 